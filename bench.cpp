@@ -0,0 +1,321 @@
+// microbenchmarks of the game's hot paths, to compare one commit against
+// another. each is run several times over, and reports the median time an
+// operation, how much that moves about from run to run, and how many heap
+// allocations an operation makes. the results can be written out as json too.
+//
+// usage: boom_tetris_bench [--runs n] [--filter text] [--json path]
+
+#include "tetris.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace boom_tetris;
+using Clock = std::chrono::steady_clock;
+
+// every allocation in the program is counted, to see what each benchmark
+// allocates.
+static std::atomic<size_t> allocations = 0;
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+// keeps the compiler from throwing away work whose result isn't used.
+template <typename T> static void keep(const T &value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  size_t iterations = 0;
+  // nanoseconds an operation, for each run.
+  std::vector<double> runs;
+  double allocationsPerOp = 0;
+
+  double median() const {
+    auto sorted = runs;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2];
+  }
+  double mean() const {
+    double total = 0;
+    for (auto run : runs) {
+      total += run;
+    }
+    return total / runs.size();
+  }
+  double stddev() const {
+    double m = mean(), total = 0;
+    for (auto run : runs) {
+      total += (run - m) * (run - m);
+    }
+    return std::sqrt(total / runs.size());
+  }
+};
+
+// runs `op` enough times for a run to take about 20ms, then does that `runs`
+// times over.
+static Result measure(const std::string &name, int runs,
+                      const std::function<void()> &op) {
+  Result result{name};
+  // warm up, and find how many times fits in a run.
+  size_t iterations = 1;
+  while (true) {
+    auto started = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      op();
+    }
+    if (Clock::now() - started > std::chrono::milliseconds(20) ||
+        iterations >= size_t(1) << 30) {
+      break;
+    }
+    iterations *= 2;
+  }
+  result.iterations = iterations;
+
+  size_t allocated = 0;
+  for (int run = 0; run < runs; ++run) {
+    auto before = allocations.load(std::memory_order_relaxed);
+    auto started = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      op();
+    }
+    std::chrono::duration<double, std::nano> took = Clock::now() - started;
+    allocated += allocations.load(std::memory_order_relaxed) - before;
+    result.runs.push_back(took.count() / iterations);
+  }
+  result.allocationsPerOp = double(allocated) / (double(iterations) * runs);
+  return result;
+}
+
+// a board with some mess on it, like the middle of a game: a few rows of
+// garbage with a well only a long bar fits, and two full rows under them.
+static GameBoard messyBoard(uint64_t seed) {
+  GameBoard board;
+  Rng rng(seed);
+  for (int y = board.height - 8; y < board.height; ++y) {
+    for (int x = 0; x < board.width; ++x) {
+      bool full = y >= board.height - 2;
+      if (full || (x != 3 && (y % 3 == 0 || rng.below(4) != 0))) {
+        board.fill(x, y, rng.below(3));
+      }
+    }
+  }
+  return board;
+}
+
+// a made up player: shuffling about, rotating and soft dropping in a pattern
+// that doesn't line up with the pieces, so it plays out a little differently
+// each time round.
+static InputFrame scriptedInput(size_t frame) {
+  InputFrame input;
+  switch (frame / 7 % 6) {
+  case 0:
+    input.press(Action::Left);
+    break;
+  case 1:
+    input.press(Action::RotateRight);
+    break;
+  case 2:
+    input.press(Action::Right);
+    input.press(Action::Down);
+    break;
+  case 3:
+    input.press(Action::RotateLeft);
+    break;
+  case 4:
+    input.press(Action::Down);
+    break;
+  }
+  return input;
+}
+
+int main(int argc, char *argv[]) {
+  int runs = 10;
+  std::string filter;
+  const char *jsonPath = nullptr;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string option = argv[i];
+    if (option == "--runs") {
+      runs = std::max(1, std::atoi(argv[i + 1]));
+    } else if (option == "--filter") {
+      filter = argv[i + 1];
+    } else if (option == "--json") {
+      jsonPath = argv[i + 1];
+    }
+  }
+
+  // no window: the assets keep their atlas on the cpu, and nothing's heard.
+  SetTraceLogLevel(LOG_WARNING);
+  auto assets = std::make_shared<Assets>();
+  Game game(assets);
+  game.silent = true;
+  game.reset();
+  game.scene = Game::Scene::InGame;
+
+  std::vector<std::pair<std::string, std::function<void()>>> benchmarks;
+
+  const auto board = messyBoard(1);
+  std::vector<Vec2> positions;
+  Rng rng(2);
+  for (int i = 0; i < 1024; ++i) {
+    positions.push_back({(int)rng.below(board.width + 2) - 1,
+                         (int)rng.below(board.height + 2) - 1});
+  }
+  size_t next = 0;
+  benchmarks.push_back({"board collides", [&] {
+                          keep(board.collides(positions[next++ % 1024]));
+                        }});
+
+  std::optional<Tetromino> piece;
+  size_t turn = 0;
+  auto nextPiece = [&] {
+    auto shape = Shape(turn % 7);
+    piece = Tetromino(shape);
+    for (size_t i = 0; i < turn % 4; ++i) {
+      piece->spinRight();
+    }
+    piece->position = {(int)(turn % 8) + 1, (int)(turn % 12) + 2};
+    turn++;
+  };
+  benchmarks.push_back({"getTransformedBlocks", [&] {
+                          nextPiece();
+                          keep(game.getTransformedBlocks(piece));
+                        }});
+
+  benchmarks.push_back({"resolveCollision", [&] {
+                          game.board = board;
+                          nextPiece();
+                          piece->saveState();
+                          piece->position.y += 10;
+                          keep(game.resolveCollision(piece));
+                        }});
+
+  benchmarks.push_back({"checkLines", [&] {
+                          game.board = board;
+                          keep(game.checkLines());
+                        }});
+
+  // what CellDissolveAnimation does with the rows once they've dissolved.
+  benchmarks.push_back({"line clear row shift", [&] {
+                          auto shifted = board;
+                          for (int line = board.height - 4;
+                               line < board.height; ++line) {
+                            shifted.removeRow(line);
+                          }
+                          keep(shifted);
+                        }});
+
+  benchmarks.push_back({"findLongBarDependencies", [&] {
+                          game.board = board;
+                          keep(game.findLongBarDependencies());
+                        }});
+
+  Game playing(assets);
+  playing.silent = true;
+  playing.reset();
+  playing.scene = Game::Scene::InGame;
+  benchmarks.push_back({"processGameLogic", [&] {
+                          if (playing.scene != Game::Scene::InGame) {
+                            playing.reset();
+                            playing.scene = Game::Scene::InGame;
+                          }
+                          playing.processGameLogic(
+                              scriptedInput(playing.frameCount));
+                        }});
+
+  // what hitting retry costs, a game over to a fresh game.
+  Game retrying(assets);
+  retrying.silent = true;
+  retrying.mode = Game::Mode::FortyLines;
+  benchmarks.push_back({"reset", [&] {
+                          retrying.reset();
+                          retrying.scene = Game::Scene::InGame;
+                          keep(retrying);
+                        }});
+
+  benchmarks.push_back({"gameGrid draw", [&] {
+                          rayui::drawList().reset(800, 600);
+                          playing.drawGame();
+                          keep(rayui::drawList());
+                        }});
+
+  // a tetris dissolving over the board in turbo, start to finish. it's frame
+  // comes from the pool, so this shouldn't allocate.
+  Game::Cue tetris = {.kind = Game::Cue::Kind::Lines, .lineCount = 4,
+                      .dissolve = true};
+  for (int i = 0; i < 4; ++i) {
+    tetris.lines[i] = board.height - 1 - i;
+  }
+  Game dissolving(assets);
+  dissolving.reset();
+  dissolving.play(tetris);
+  benchmarks.push_back({"dissolve effect", [&] {
+                          dissolving.particles.clear();
+                          dissolving.play(tetris);
+                          while (!dissolving.effectPlayer.empty()) {
+                            rayui::drawList().reset(800, 600);
+                            dissolving.effectPlayer.draw(
+                                {1 / 60.0f, &rayui::drawList(), {0, 0},
+                                 {32, 32}});
+                          }
+                          keep(rayui::drawList());
+                        }});
+
+  std::vector<Result> results;
+  printf("%-26s %12s %10s %8s %12s\n", "", "ns/op", "min", "cv", "allocs/op");
+  for (const auto &[name, op] : benchmarks) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+      continue;
+    }
+    auto result = measure(name, runs, op);
+    auto fastest = *std::min_element(result.runs.begin(), result.runs.end());
+    printf("%-26s %12.2f %10.2f %7.2f%% %12.3f\n", name.c_str(),
+           result.median(), fastest, 100 * result.stddev() / result.mean(),
+           result.allocationsPerOp);
+    results.push_back(std::move(result));
+  }
+
+  if (jsonPath) {
+    auto file = fopen(jsonPath, "w");
+    if (!file) {
+      fprintf(stderr, "couldn't write %s\n", jsonPath);
+      return 1;
+    }
+    fprintf(file, "{\"runs\":%d,\"benchmarks\":[", runs);
+    for (size_t i = 0; i < results.size(); ++i) {
+      const auto &result = results[i];
+      fprintf(file,
+              "%s\n  {\"name\":\"%s\",\"iterations\":%zu,"
+              "\"ns_per_op\":%.3f,\"mean_ns\":%.3f,\"stddev_ns\":%.3f,"
+              "\"allocations_per_op\":%.3f,\"runs_ns\":[",
+              i ? "," : "", result.name.c_str(), result.iterations,
+              result.median(), result.mean(), result.stddev(),
+              result.allocationsPerOp);
+      for (size_t r = 0; r < result.runs.size(); ++r) {
+        fprintf(file, "%s%.3f", r ? "," : "", result.runs[r]);
+      }
+      fprintf(file, "]}");
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+  }
+  return 0;
+}
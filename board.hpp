@@ -0,0 +1,169 @@
+#pragma once
+#include "shape.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace boom_tetris {
+
+// the rotation of a tetromino
+enum struct Orientation { Up, Right, Down, Left };
+// an integer based vec2.
+struct Vec2 {
+  int x, y;
+
+  constexpr Vec2 operator+(const Vec2 &other) const {
+    return {this->x + other.x, this->y + other.y};
+  }
+
+  constexpr Vec2 rotated(Orientation orientation) const {
+    switch (orientation) {
+    case Orientation::Up:
+      return *this;
+    case Orientation::Left:
+      return {-this->y, this->x};
+    case Orientation::Down:
+      return {-this->x, -this->y};
+    case Orientation::Right:
+      return {this->y, -this->x};
+    }
+    return *this;
+  }
+};
+// an image associated with a cell.
+struct Block {
+  Vec2 pos;
+  size_t imageIdx;
+};
+
+// the cells of every shape, relative to it's pivot, indexed by `Shape`.
+constexpr std::array<std::array<Block, 4>, shapeCount> shapePatterns = {{
+    {{{{-1, 1}, 1}, {{-1, 0}, 1}, {{0, 0}, 1}, {{1, 0}, 1}}}, // L
+    {{{{-1, 0}, 0}, {{0, 0}, 0}, {{1, 0}, 0}, {{1, 1}, 0}}},  // J
+    {{{{-1, 0}, 1}, {{0, 0}, 1}, {{0, 1}, 1}, {{1, 1}, 1}}},  // Z
+    {{{{-1, 1}, 0}, {{0, 1}, 0}, {{0, 0}, 0}, {{1, 0}, 0}}},  // S
+    {{{{-1, 0}, 3}, {{0, 0}, 3}, {{1, 0}, 3}, {{2, 0}, 3}}},  // I
+    {{{{-1, 0}, 3}, {{0, 0}, 3}, {{1, 0}, 3}, {{0, 1}, 3}}},  // T
+    {{{{0, 0}, 2}, {{0, 1}, 2}, {{1, 0}, 2}, {{1, 1}, 2}}},   // O
+}};
+
+// how many distinct orientations a shape cycles through when spun.
+constexpr int orientationCount(Shape shape) {
+  switch (shape) {
+  case Shape::Z:
+  case Shape::S:
+  case Shape::I:
+    return 2;
+  case Shape::O:
+    return 1;
+  default:
+    return 4;
+  }
+}
+
+// the narrowest word that has a bit for every column of a row.
+template <int Width>
+using RowBits = std::conditional_t<
+    (Width <= 16), uint16_t,
+    std::conditional_t<(Width <= 32), uint32_t, uint64_t>>;
+
+// the play grid. each row is one word with a bit set per filled column, so
+// collision and line checks are a shift and a mask; the image of every cell is
+// kept next to it for drawing. the top `Hidden` rows are a spawn buffer that's
+// part of the board but never drawn.
+template <int W, int H, int Hidden = 0> struct Board {
+  static_assert(W > 0 && W <= 64, "a row has to fit in a 64 bit word");
+  static_assert(Hidden >= 0 && Hidden < H);
+
+  static constexpr int width = W;
+  static constexpr int height = H;
+  static constexpr int hiddenRows = Hidden;
+  static constexpr int visibleHeight = H - Hidden;
+
+  using Row = RowBits<W>;
+  static constexpr Row fullRow = Row(Row(~Row(0)) >> (sizeof(Row) * 8 - W));
+
+  std::array<Row, H> rows = {};
+  std::array<std::array<uint8_t, W>, H> images = {};
+
+  static constexpr bool inBounds(int x, int y) noexcept {
+    return x >= 0 && x < W && y >= 0 && y < H;
+  }
+
+  // the accessors below don't check bounds; see `inBounds`.
+  bool empty(int x, int y) const noexcept { return !((rows[y] >> x) & 1); }
+  uint8_t image(int x, int y) const noexcept { return images[y][x]; }
+  void fill(int x, int y, size_t imageIdx) noexcept {
+    rows[y] |= Row(1) << x;
+    images[y][x] = imageIdx;
+  }
+  void clear(int x, int y) noexcept { rows[y] &= Row(~(Row(1) << x)); }
+  bool full(int y) const noexcept { return rows[y] == fullRow; }
+
+  // We need more information that just whether it collided or not: we need to
+  // know what side we hit so we can depenetrate in the opposite direction.
+  bool collides(Vec2 pos) const noexcept {
+    return inBounds(pos.x, pos.y) && !empty(pos.x, pos.y);
+  }
+
+  // drop every row above `line` down by one, leaving an empty row on top.
+  void removeRow(int line) noexcept {
+    for (int y = line; y >= 1; --y) {
+      rows[y] = rows[y - 1];
+      images[y] = images[y - 1];
+    }
+    rows[0] = 0;
+  }
+
+  // push every row up by one and put `row` in at the bottom, every filled cell
+  // of it showing `imageIdx`. returns false if a filled cell got pushed out of
+  // the top.
+  [[nodiscard]] bool raiseRow(Row row, size_t imageIdx) noexcept {
+    bool toppedOut = rows[0] != 0;
+    for (int y = 0; y < H - 1; ++y) {
+      rows[y] = rows[y + 1];
+      images[y] = images[y + 1];
+    }
+    rows[H - 1] = row & fullRow;
+    images[H - 1].fill(imageIdx);
+    return !toppedOut;
+  }
+};
+
+// a well is a dependency when both of it's sides are filled (or the wall) and
+// it's at least 3 cells deep, so only a long bar can fill it.
+template <int W, int H, int Hidden>
+bool checkDependency(const Board<W, H, Hidden> &board, int x, int y) {
+  bool left = x - 1 < 0 || !board.empty(x - 1, y);
+  bool right = x + 1 >= W || !board.empty(x + 1, y);
+  if (!left || !right) {
+    return false;
+  }
+  for (int dy = y + 2; dy > y; --dy) {
+    if (!board.empty(x, dy)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// how many columns have a well only a long bar can fill.
+template <int W, int H, int Hidden>
+int findLongBarDependencies(const Board<W, H, Hidden> &board) {
+  int count = 0;
+  for (int x = 0; x < W; ++x) {
+    for (int y = 0; y < H - 2; ++y) {
+      if (!board.empty(x, y)) {
+        break;
+      }
+      if (checkDependency(board, x, y)) {
+        count++;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+} // namespace boom_tetris
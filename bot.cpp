@@ -0,0 +1,59 @@
+#include "bot.hpp"
+#include "tetris.hpp"
+
+using namespace boom_tetris;
+
+InputFrame Bot::play(const Game &game) {
+  InputFrame input;
+  if (!game.tetromino) {
+    lastInput = input;
+    return input;
+  }
+  const auto &piece = *game.tetromino;
+
+  if (game.pieceCount != plannedPiece) {
+    // the falling piece is drawn into the board, take it back out.
+    auto board = game.board;
+    for (const auto &block : shapePatterns[(int)piece.shape]) {
+      auto pos = piece.position + block.pos.rotated(piece.orientation);
+      if (board.inBounds(pos.x, pos.y)) {
+        board.clear(pos.x, pos.y);
+      }
+    }
+    target = bestPlacement(board, piece.shape);
+    plannedPiece = game.pieceCount;
+    framesOnPiece = 0;
+    wait = inputDelay;
+  }
+  framesOnPiece++;
+
+  // let go between taps, every press has to be a new one.
+  bool tapped = lastInput.held & ~uint8_t(Action::Down);
+  if (!target || framesOnPiece > 120) {
+    input.press(Action::Down);
+  } else if (tapped || wait > 0) {
+    wait--;
+  } else {
+    int orientations = orientationCount(piece.shape);
+    int spins = ((int)target->orientation - (int)piece.orientation +
+                 orientations) %
+                orientations;
+    if (spins == 3) {
+      input.press(Action::RotateLeft);
+    } else if (spins > 0) {
+      input.press(Action::RotateRight);
+    } else if (piece.position.x < target->position.x) {
+      input.press(Action::Right);
+    } else if (piece.position.x > target->position.x) {
+      input.press(Action::Left);
+    } else {
+      input.press(Action::Down);
+    }
+    if (!input.down(Action::Down)) {
+      wait = inputDelay;
+    }
+  }
+
+  lastInput = input;
+  return input;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "input.hpp"
+#include "placement.hpp"
+#include <bit>
+#include <cstdlib>
+#include <cstddef>
+#include <optional>
+
+namespace boom_tetris {
+
+struct Game;
+
+// how good a board looks after a placement, higher is better. the weights are
+// the well known ones from Yiyuan Lee's tetris ai: keep the stack low and flat,
+// clear lines, and don't make holes.
+template <typename BoardType>
+float evaluateBoard(const BoardType &board, int linesCleared) {
+  auto tops = columnTops(board);
+  int aggregateHeight = 0, bumpiness = 0, holes = 0;
+  for (int x = 0; x < board.width; ++x) {
+    aggregateHeight += board.height - tops[x];
+    if (x > 0) {
+      bumpiness += std::abs(tops[x] - tops[x - 1]);
+    }
+  }
+  // an empty cell with anything above it is a hole.
+  using Row = typename BoardType::Row;
+  Row covered = 0;
+  for (int y = 0; y < board.height; ++y) {
+    holes += std::popcount(Row(covered & ~board.rows[y]));
+    covered |= board.rows[y];
+  }
+  return -0.510066f * aggregateHeight + 0.760666f * linesCleared -
+         0.35663f * holes - 0.184483f * bumpiness;
+}
+
+// the best place to drop `shape`, if it fits anywhere.
+template <typename BoardType>
+std::optional<Placement> bestPlacement(const BoardType &board, Shape shape) {
+  std::optional<Placement> best;
+  float bestScore = 0;
+  forEachDrop(board, shape, [&](const Placement &placement) {
+    auto next = board;
+    if (!place(next, placement)) {
+      return false;
+    }
+    auto score = evaluateBoard(next, clearFullRows(next));
+    if (!best || score > bestScore) {
+      best = placement;
+      bestScore = score;
+    }
+    return false;
+  });
+  return best;
+}
+
+// a computer player. when a piece spawns it picks where it should go, then
+// taps the same buttons a player would to get it there.
+struct Bot {
+  // frames to wait between button presses. higher is easier to beat.
+  int inputDelay = 2;
+
+  // the piece the current plan is for, by `Game::pieceCount`.
+  size_t plannedPiece = 0;
+  std::optional<Placement> target;
+  // frames spent on this piece, so a plan that can't be reached is dropped.
+  int framesOnPiece = 0;
+  int wait = 0;
+  InputFrame lastInput;
+
+  // the buttons to hold this frame.
+  InputFrame play(const Game &game);
+};
+
+} // namespace boom_tetris
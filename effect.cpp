@@ -0,0 +1,100 @@
+#include "effect.hpp"
+#include "log.hpp"
+#include <memory>
+#include <new>
+
+using namespace boom_tetris;
+
+namespace {
+
+// every effect's frame comes from here, a fixed number of fixed size slots
+// made the first time an effect plays. each thread has it's own, effects are
+// made and thrown away on the thread drawing them.
+struct FramePool {
+  std::unique_ptr<std::byte[]> memory =
+      std::make_unique<std::byte[]>(Effect::poolSlots * Effect::slotSize);
+  std::vector<void *> free;
+  size_t unpooled = 0;
+
+  FramePool() {
+    free.reserve(Effect::poolSlots);
+    for (size_t i = Effect::poolSlots; i-- > 0;) {
+      free.push_back(memory.get() + i * Effect::slotSize);
+    }
+  }
+};
+
+// in front of every frame, to tell where it goes back to.
+struct alignas(std::max_align_t) Header {
+  bool pooled;
+};
+
+FramePool &pool() {
+  thread_local std::unique_ptr<FramePool> pool =
+      std::make_unique<FramePool>();
+  return *pool;
+}
+
+} // namespace
+
+size_t Effect::unpooled() { return pool().unpooled; }
+
+void *Effect::promise_type::operator new(size_t size) noexcept {
+  auto &frames = pool();
+  void *memory = nullptr;
+  bool pooled = size + sizeof(Header) <= slotSize && !frames.free.empty();
+  if (pooled) {
+    memory = frames.free.back();
+    frames.free.pop_back();
+  } else {
+    logWarning("effect frame of {} bytes came off the heap, {} slots free",
+               size, frames.free.size());
+    frames.unpooled++;
+    memory = ::operator new(size + sizeof(Header), std::nothrow);
+    if (!memory) {
+      return nullptr;
+    }
+  }
+  return new (memory) Header{pooled} + 1;
+}
+
+void Effect::promise_type::operator delete(void *frame) noexcept {
+  auto header = static_cast<Header *>(frame) - 1;
+  if (header->pooled) {
+    pool().free.push_back(header);
+  } else {
+    ::operator delete(header);
+  }
+}
+
+bool Effect::resume(const EffectFrame &frame) {
+  if (done()) {
+    return false;
+  }
+  handle.promise().frame = &frame;
+  handle.resume();
+  return !handle.done();
+}
+
+void EffectPlayer::play(Effect effect) {
+  if (effect.done()) {
+    return;
+  }
+  if (playing.capacity() == 0) {
+    playing.reserve(Effect::poolSlots);
+  }
+  playing.push_back(std::move(effect));
+}
+
+void EffectPlayer::draw(const EffectFrame &frame) {
+  // the order doesn't matter, so a finished effect is swapped out for the last
+  // one.
+  for (size_t i = 0; i < playing.size();) {
+    if (playing[i].resume(frame)) {
+      ++i;
+      continue;
+    }
+    std::swap(playing[i], playing.back());
+    playing.pop_back();
+  }
+}
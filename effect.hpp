@@ -0,0 +1,109 @@
+#pragma once
+#include "rayui.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <vector>
+
+namespace boom_tetris {
+
+// what an effect gets each frame: how long since the last one, and where to
+// draw, in the same units as `Particles`.
+struct EffectFrame {
+  float seconds = 0;
+  rayui::DrawList *list = nullptr;
+  Vector2 origin = {0, 0};
+  Vector2 scale = {1, 1};
+};
+
+// something only for show, written as a coroutine that draws a frame and
+// then waits for the next one:
+//
+//   Effect fade(Color color) {
+//     for (float t = 0; t < 1;) {
+//       auto &frame = co_await Effect::nextFrame();
+//       t += frame.seconds;
+//       ...
+//     }
+//   }
+//
+// it's state lives in the coroutine, in a frame taken from a fixed pool
+// instead of the heap. a frame too big for a slot, or one made while the
+// pool's used up, comes off the heap instead with a warning. effects can't be
+// copied into a snapshot, so nothing the game plays out may depend on one.
+class Effect {
+public:
+  struct promise_type {
+    const EffectFrame *frame = nullptr;
+
+    Effect get_return_object() {
+      return Effect(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    static Effect get_return_object_on_allocation_failure() { return {}; }
+    // effects start on the first frame they're drawn.
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+
+    static void *operator new(size_t size) noexcept;
+    static void operator delete(void *frame) noexcept;
+  };
+
+  // waits for the next frame, and gives it back.
+  struct NextFrame {
+    promise_type *promise = nullptr;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+      promise = &handle.promise();
+    }
+    const EffectFrame &await_resume() const noexcept {
+      return *promise->frame;
+    }
+  };
+  static NextFrame nextFrame() { return {}; }
+
+  Effect() = default;
+  Effect(Effect &&other) noexcept : handle(other.handle) {
+    other.handle = nullptr;
+  }
+  Effect &operator=(Effect &&other) noexcept {
+    std::swap(handle, other.handle);
+    return *this;
+  }
+  ~Effect() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  bool done() const { return !handle || handle.done(); }
+  // runs the effect up to it's next frame. false once it's finished.
+  bool resume(const EffectFrame &frame);
+
+  // the most effects the pool holds at once, and the most a slot holds, it's
+  // frame and a little bookkeeping.
+  static constexpr size_t poolSlots = 64;
+  static constexpr size_t slotSize = 512;
+  // how many frames this thread has had to take off the heap.
+  static size_t unpooled();
+
+private:
+  explicit Effect(std::coroutine_handle<promise_type> handle)
+      : handle(handle) {}
+  std::coroutine_handle<promise_type> handle;
+};
+
+// plays any number of effects side by side, each on it's own time.
+class EffectPlayer {
+public:
+  void play(Effect effect);
+  // runs every effect up to this frame, and drops the ones that are done.
+  void draw(const EffectFrame &frame);
+  void clear() { playing.clear(); }
+  bool empty() const { return playing.empty(); }
+
+private:
+  std::vector<Effect> playing;
+};
+
+} // namespace boom_tetris
@@ -0,0 +1,140 @@
+#pragma once
+#include "placement.hpp"
+#include "randomizer.hpp"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace boom_tetris {
+
+// tries to fill and clear row `target` with at most `depth` pieces dropped
+// straight down. on success `board` is left with the row cleared and
+// `cleared` says how many rows went with it. every placement tried costs one
+// unit of `budget`.
+template <typename BoardType>
+bool clearGarbageRow(BoardType &board, int target, int depth, int &budget,
+                     int &cleared) {
+  using Row = typename BoardType::Row;
+  bool solved = false;
+  for (int s = 0; s < shapeCount && !solved && budget > 0; ++s) {
+    forEachDrop(board, Shape(s), [&](const Placement &placement) {
+      if (--budget <= 0) {
+        return true;
+      }
+      // anything that doesn't fill a hole of the row just gets in the way.
+      if (!touchesRow(placement, target)) {
+        return false;
+      }
+      auto next = board;
+      if (!place(next, placement)) {
+        return false;
+      }
+      if (next.full(target)) {
+        cleared = clearFullRows(next);
+      } else {
+        // give up on this one if it buried what's left of the row.
+        Row above = 0;
+        for (int y = 0; y < target; ++y) {
+          above |= next.rows[y];
+        }
+        auto holes = Row(~next.rows[target] & BoardType::fullRow);
+        if (depth <= 1 || (above & holes) ||
+            !clearGarbageRow(next, target, depth - 1, budget, cleared)) {
+          return false;
+        }
+      }
+      board = next;
+      solved = true;
+      return true;
+    });
+  }
+  return solved;
+}
+
+// whether `rows` of garbage, listed top to bottom and sitting on the floor of
+// an otherwise empty board, can be dug out completely. rows are dug one at a
+// time from the top with up to two pieces each, assuming any shape can come
+// next. running out of `budget` counts as not clearable.
+template <typename BoardType>
+bool garbageClearable(std::span<const typename BoardType::Row> rows,
+                      int &budget) {
+  BoardType board;
+  int remaining = rows.size();
+  if (remaining > board.height - 4) {
+    return false;
+  }
+  for (int i = 0; i < remaining; ++i) {
+    if (!board.raiseRow(rows[i], 0)) {
+      return false;
+    }
+  }
+  while (remaining > 0) {
+    int cleared = 0;
+    if (!clearGarbageRow(board, board.height - remaining, 2, budget,
+                         cleared)) {
+      return false;
+    }
+    remaining -= cleared;
+  }
+  return true;
+}
+
+// makes rows of garbage for dig mode: full rows with one or two holes, only
+// ever handed out once they're known to be clearable.
+template <typename BoardType> struct GarbageGenerator {
+  using Row = typename BoardType::Row;
+
+  Rng rng;
+  // placements the clearability search may try for one batch before it's
+  // rerolled. this bounds a batch to a few microseconds of work.
+  int searchBudget = 1024;
+  // the chance, out of 100, of a row getting a second hole.
+  int twoHoleChance = 25;
+
+  GarbageGenerator(uint64_t seed = 0) : rng(seed) {}
+
+  Row randomRow() {
+    auto row = BoardType::fullRow;
+    row &= Row(~(Row(1) << rng.below(BoardType::width)));
+    if (rng.below(100) < (uint32_t)twoHoleChance) {
+      row &= Row(~(Row(1) << rng.below(BoardType::width)));
+    }
+    return row;
+  }
+
+  // `count` rows to go in under `existing`, the garbage already on the board
+  // listed top to bottom, such that all of it together can be dug out.
+  std::vector<Row> generate(int count, std::span<const Row> existing = {}) {
+    std::vector<Row> rows(existing.begin(), existing.end());
+    // only as much as fits on a board with room to spare can be checked, and
+    // the new rows are at the bottom.
+    const size_t checkable = BoardType::height - 4;
+
+    for (int attempt = 0; attempt < 8; ++attempt) {
+      rows.resize(existing.size());
+      for (int i = 0; i < count; ++i) {
+        rows.push_back(randomRow());
+      }
+      auto checked = std::span<const Row>(rows).last(
+          std::min(rows.size(), checkable));
+      int budget = searchBudget;
+      if (garbageClearable<BoardType>(checked, budget)) {
+        return std::vector<Row>(rows.end() - count, rows.end());
+      }
+    }
+
+    // give up on holes anywhere: single holes that never line up under each
+    // other can always be dug through once the rows above are gone.
+    std::vector<Row> fallback;
+    int previous = -1;
+    for (int i = 0; i < count; ++i) {
+      int hole = rng.below(BoardType::width - 1);
+      hole += hole >= previous && previous >= 0 ? 1 : 0;
+      fallback.push_back(Row(BoardType::fullRow & ~(Row(1) << hole)));
+      previous = hole;
+    }
+    return fallback;
+  }
+};
+
+} // namespace boom_tetris
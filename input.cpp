@@ -0,0 +1,100 @@
+#include "input.hpp"
+#include "score.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace boom_tetris;
+
+namespace {
+
+std::string bindingsPath() {
+  auto scores = ScoreFile::getScoreFilePath();
+  if (scores.empty()) {
+    return "";
+  }
+  return (std::filesystem::path(scores).parent_path() / "controls").string();
+}
+
+} // namespace
+
+bool Bindings::read() {
+  auto filename = bindingsPath();
+  if (filename.empty()) {
+    return false;
+  }
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return false;
+  }
+  for (size_t i = 0; i < actions && file; ++i) {
+    int first, second, button;
+    if (file >> first >> second >> button) {
+      keys[i] = {first, second};
+      buttons[i] = button;
+    }
+  }
+  return true;
+}
+
+void Bindings::write() const {
+  auto filename = bindingsPath();
+  if (filename.empty()) {
+    return;
+  }
+  std::ofstream file(filename);
+  for (size_t i = 0; i < actions; ++i) {
+    file << keys[i][0] << " " << keys[i][1] << " " << buttons[i] << "\n";
+  }
+}
+
+void InputDevices::update() {
+  // raylib keeps track of connections as it polls, this just notices them
+  // changing.
+  uint8_t now = 0;
+  for (int i = 0; i < maxGamepads; ++i) {
+    if (IsGamepadAvailable(i)) {
+      now |= 1 << i;
+    }
+  }
+  if (now != connected) {
+    connected = now;
+    padCount = 0;
+    for (int i = 0; i < maxGamepads; ++i) {
+      if (connected & (1 << i)) {
+        pads[padCount++] = i;
+      }
+    }
+  }
+
+  keys = {};
+  for (size_t i = 0; i < Bindings::actions; ++i) {
+    for (auto key : bindings.keys[i]) {
+      if (key != 0 && IsKeyDown(key)) {
+        keys.held |= 1 << i;
+      }
+    }
+  }
+  padInputs = {};
+  for (size_t p = 0; p < padCount; ++p) {
+    for (size_t i = 0; i < Bindings::actions; ++i) {
+      if (IsGamepadButtonDown(pads[p], bindings.buttons[i])) {
+        padInputs[pads[p]].held |= 1 << i;
+      }
+    }
+  }
+}
+
+InputFrame InputDevices::gamepad(int gamepad) const {
+  if (gamepad < 0 || gamepad >= maxGamepads) {
+    return {};
+  }
+  return padInputs[gamepad];
+}
+
+InputFrame InputDevices::player() const {
+  auto input = keys;
+  if (padCount > 0) {
+    input.held |= padInputs[pads[0]].held;
+  }
+  return input;
+}
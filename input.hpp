@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <raylib.h>
+#include <span>
+
+namespace boom_tetris {
+
+// what a player can do, one bit each.
+enum struct Action : uint8_t {
+  Left = 1 << 0,
+  Right = 1 << 1,
+  Down = 1 << 2,
+  RotateLeft = 1 << 3,
+  RotateRight = 1 << 4,
+};
+
+// every button held down on one frame. presses are worked out by comparing
+// against the previous frame, so this is all a game needs from a player, be
+// it a keyboard, a gamepad or a bot.
+struct InputFrame {
+  uint8_t held = 0;
+
+  bool down(Action action) const { return held & uint8_t(action); }
+  void press(Action action) { held |= uint8_t(action); }
+  // held now, but not on `previous`.
+  bool pressed(Action action, InputFrame previous) const {
+    return down(action) && !previous.down(action);
+  }
+};
+
+// which keys and gamepad buttons do what, as raylib numbers them, in the
+// order of the bits in `Action`. each action has up to two keys, 0 for none,
+// and one gamepad button.
+struct Bindings {
+  static constexpr size_t actions = 5;
+  // arrows to move and soft drop, z to rotate left, x or up to rotate right.
+  std::array<std::array<int, 2>, actions> keys = {
+      {{KEY_LEFT, 0},
+       {KEY_RIGHT, 0},
+       {KEY_DOWN, 0},
+       {KEY_Z, 0},
+       {KEY_X, KEY_UP}}};
+  // the d-pad moves, A and B (on an xbox controller) rotate.
+  std::array<int, actions> buttons = {
+      GAMEPAD_BUTTON_LEFT_FACE_LEFT, GAMEPAD_BUTTON_LEFT_FACE_RIGHT,
+      GAMEPAD_BUTTON_LEFT_FACE_DOWN, GAMEPAD_BUTTON_RIGHT_FACE_DOWN,
+      GAMEPAD_BUTTON_RIGHT_FACE_RIGHT};
+
+  // `controls` next to the score file: a line an action, it's two keys then
+  // it's button. anything missing is left as it was. false if there's no
+  // file.
+  bool read();
+  void write() const;
+};
+
+// the keyboard and gamepads. everything bound is read once a frame into an
+// `InputFrame` each, so nothing else has to ask raylib.
+class InputDevices {
+public:
+  // raylib's limit.
+  static constexpr int maxGamepads = 4;
+
+  Bindings bindings;
+
+  // call once raylib's polled input. notices gamepads being plugged in or
+  // out, and samples every bound key and button.
+  void update();
+  // the connected gamepads, lowest first.
+  std::span<const int> gamepads() const { return {pads.data(), padCount}; }
+
+  InputFrame keyboard() const { return keys; }
+  // a connected gamepad's input, nothing for any other.
+  InputFrame gamepad(int gamepad) const;
+  // the keyboard and the first gamepad together, for a solo game.
+  InputFrame player() const;
+
+private:
+  // a bit for each gamepad, connected or not.
+  uint8_t connected = 0;
+  std::array<int, maxGamepads> pads = {};
+  size_t padCount = 0;
+  InputFrame keys;
+  std::array<InputFrame, maxGamepads> padInputs;
+};
+
+} // namespace boom_tetris
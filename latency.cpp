@@ -0,0 +1,72 @@
+#include "latency.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace boom_tetris;
+
+void LatencyMeter::shown(Clock::time_point pressed) {
+  // if two presses land in one frame, the first one waited longest.
+  if (!pending || pressed < *pending) {
+    pending = pressed;
+  }
+}
+
+void LatencyMeter::presented(Clock::time_point now) {
+  if (pending) {
+    samples.push_back(
+        std::chrono::duration<float, std::milli>(now - *pending).count());
+    pending.reset();
+  }
+}
+
+LatencyMeter::Summary LatencyMeter::summary() const {
+  Summary summary;
+  summary.count = samples.size();
+  if (samples.empty()) {
+    return summary;
+  }
+  auto sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&](float p) {
+    return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+  };
+  float total = 0;
+  for (auto sample : sorted) {
+    total += sample;
+  }
+  summary.mean = total / sorted.size();
+  summary.p50 = percentile(0.5f);
+  summary.p95 = percentile(0.95f);
+  summary.p99 = percentile(0.99f);
+  summary.max = sorted.back();
+  return summary;
+}
+
+void LatencyMeter::draw(rayui::DrawList &list) {
+  if (!visible) {
+    return;
+  }
+  if (summarized != samples.size()) {
+    summarized = samples.size();
+    auto s = summary();
+    snprintf(text[0], sizeof(text[0]), "input to screen: %zu presses", s.count);
+    snprintf(text[1], sizeof(text[1]),
+             "mean %.1f p50 %.1f p95 %.1f p99 %.1f max %.1f ms", s.mean, s.p50,
+             s.p95, s.p99, s.max);
+  }
+  list.rectangle(4, 4, 420, 44, GetColor(0x000000cc));
+  list.text(text[0], 10, 8, 16, GREEN);
+  list.text(text[1], 10, 28, 16, GREEN);
+}
+
+bool LatencyMeter::writeCsv(const char *path) const {
+  auto file = fopen(path, "w");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "press,latency_ms\n");
+  for (size_t i = 0; i < samples.size(); ++i) {
+    fprintf(file, "%zu,%.3f\n", i, samples[i]);
+  }
+  return fclose(file) == 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "rayui.hpp"
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace boom_tetris {
+
+// how long a button press takes to show up on screen: from the input poll
+// that first saw it, to the end of presenting the first frame drawn from a
+// tick that acted on it. raylib doesn't say when a key actually went down, so
+// time spent before the poll isn't counted.
+class LatencyMeter {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // the frame being drawn is the first to show a press seen at `pressed`.
+  void shown(Clock::time_point pressed);
+  // call as soon as the frame's presented.
+  void presented(Clock::time_point now = Clock::now());
+
+  // in milliseconds, over every press so far.
+  struct Summary {
+    size_t count = 0;
+    float mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+  };
+  Summary summary() const;
+
+  bool visible = false;
+  // the summary in the top left corner, if it's `visible`.
+  void draw(rayui::DrawList &list);
+  // every press's latency in milliseconds, one a line.
+  bool writeCsv(const char *path) const;
+
+private:
+  std::optional<Clock::time_point> pending;
+  std::vector<float> samples;
+  // the overlay's text, only worked out again once there's more samples.
+  size_t summarized = ~size_t(0);
+  char text[2][96] = {};
+};
+
+} // namespace boom_tetris
@@ -0,0 +1,162 @@
+#include "log.hpp"
+#include <ctime>
+
+using namespace boom_tetris;
+
+namespace {
+
+const char *levelNames[] = {"debug", "info", "warning", "error"};
+
+int64_t steadyNow() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+} // namespace
+
+Logger &boom_tetris::logger() {
+  static Logger logger;
+  return logger;
+}
+
+Logger::Logger() : queue(std::make_unique<Queue>()) {
+  limit(20, 50);
+  writer = std::thread([this] {
+    while (!stopping.load(std::memory_order_relaxed)) {
+      flush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  });
+}
+
+void Logger::limit(double perSecond, int burst) {
+  auto ticks = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1 / perSecond));
+  interval = ticks.count();
+  this->burst = burst;
+}
+
+void Logger::stop() {
+  if (!writer.joinable()) {
+    return;
+  }
+  stopping = true;
+  writer.join();
+  flush();
+  stopped = true;
+}
+
+bool Logger::allow(LogLevel level) {
+  if (level == LogLevel::Error) {
+    return true;
+  }
+  // each message takes up `interval` from the level's next free slot. that
+  // can run up to `burst` messages ahead of now, and no further.
+  const auto step = interval.load(std::memory_order_relaxed);
+  const auto ahead = step * burst.load(std::memory_order_relaxed);
+  const auto now = steadyNow();
+  auto &next = nextAllowed[(size_t)level];
+  auto slot = next.load(std::memory_order_relaxed);
+  while (true) {
+    auto from = std::max(slot, now);
+    if (from - now >= ahead) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (next.compare_exchange_weak(slot, from + step,
+                                   std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+void Logger::push(const Record &record) {
+  if (stopped.load(std::memory_order_acquire)) {
+    // nobody's left to write it, and nothing's waiting on the frame anymore.
+    write(record);
+  } else if (!queue->push(record)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Logger::flush() {
+  while (auto record = queue->pop()) {
+    write(*record);
+  }
+  if (auto count = dropped.exchange(0, std::memory_order_relaxed)) {
+    Record record = {.level = LogLevel::Warning,
+                     .at = Clock::now(),
+                     .format = "dropped {} log messages, they came too fast"};
+    record.add(count);
+    write(record);
+  }
+  fflush(out);
+}
+
+void Logger::Record::add(std::string_view value) {
+  if (textUsed == text.size()) {
+    // out of room, it comes out empty.
+    kinds[count] = Kind::Text;
+    values[count++].u = text.size() - 1;
+    return;
+  }
+  const size_t room = text.size() - textUsed - 1;
+  const auto length = std::min(value.size(), room);
+  kinds[count] = Kind::Text;
+  values[count++].u = textUsed;
+  value.copy(text.data() + textUsed, length);
+  textUsed += length;
+  text[textUsed++] = '\0';
+}
+
+void Logger::write(const Record &record) {
+  char line[512];
+  size_t used = 0;
+  auto append = [&](auto... args) {
+    if (used < sizeof(line)) {
+      auto wrote = snprintf(line + used, sizeof(line) - used, args...);
+      used = std::min(sizeof(line) - 1, used + std::max(wrote, 0));
+    }
+  };
+
+  auto time = Clock::to_time_t(record.at);
+  std::tm local;
+#ifdef _WIN32
+  localtime_s(&local, &time);
+#else
+  localtime_r(&time, &local);
+#endif
+  auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    record.at.time_since_epoch())
+                    .count() %
+                1000;
+  append("[%02d:%02d:%02d.%03d] %s: ", local.tm_hour, local.tm_min,
+         local.tm_sec, (int)millis, levelNames[(size_t)record.level]);
+
+  size_t arg = 0;
+  for (auto c = record.format; *c; ++c) {
+    if (c[0] == '{' && c[1] == '}' && arg < record.count) {
+      const auto value = record.values[arg];
+      switch (record.kinds[arg++]) {
+      case Record::Kind::Int:
+        append("%lld", (long long)value.i);
+        break;
+      case Record::Kind::Unsigned:
+        append("%llu", (unsigned long long)value.u);
+        break;
+      case Record::Kind::Float:
+        append("%g", value.f);
+        break;
+      case Record::Kind::Text:
+        append("%s", record.text.data() + value.u);
+        break;
+      }
+      ++c;
+    } else if (used < sizeof(line) - 1) {
+      line[used++] = *c;
+      line[used] = '\0';
+    }
+  }
+  append("\n");
+  // one write a message, so two threads' messages never interleave.
+  fputs(line, out);
+}
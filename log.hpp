@@ -0,0 +1,127 @@
+#pragma once
+#include "mpsc_queue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace boom_tetris {
+
+enum struct LogLevel : uint8_t { Debug, Info, Warning, Error };
+
+// logging that never holds up a frame. a message is copied into a fixed size
+// record on a queue, and a thread of it's own formats and writes it out. a
+// full queue, or a level logging faster than it's allowed, drops messages
+// instead of waiting, and says how many once it catches up.
+//
+// messages fill in each `{}` in `format` with the next argument, numbers or
+// text. `format` is kept as a pointer, so it has to be a string literal.
+class Logger {
+public:
+  using Clock = std::chrono::system_clock;
+  static constexpr size_t maxArgs = 4;
+
+  Logger();
+  ~Logger() { stop(); }
+  Logger(const Logger &) = delete;
+  Logger &operator=(const Logger &) = delete;
+
+  // messages under this level are skipped without being queued.
+  std::atomic<LogLevel> level = LogLevel::Info;
+
+  // how many messages of a level can go out a second, after a burst of
+  // `burst`. errors aren't limited.
+  void limit(double perSecond, int burst);
+  // writes out everything queued, and stops the thread. anything logged
+  // after this is written straight away.
+  void stop();
+
+  template <typename... Args>
+  void log(LogLevel level, const char *format, const Args &...args) {
+    static_assert(sizeof...(Args) <= maxArgs, "too many arguments to log");
+    if (level < this->level.load(std::memory_order_relaxed) || !allow(level)) {
+      return;
+    }
+    Record record = {.level = level, .at = Clock::now(), .format = format};
+    (record.add(args), ...);
+    push(record);
+  }
+
+private:
+  struct Record {
+    enum struct Kind : uint8_t { Int, Unsigned, Float, Text };
+    LogLevel level;
+    uint8_t count = 0;
+    uint8_t textUsed = 0;
+    std::array<Kind, maxArgs> kinds = {};
+    Clock::time_point at;
+    const char *format;
+    // text arguments are copied in here, and their values are where.
+    union Value {
+      int64_t i;
+      uint64_t u;
+      double f;
+    };
+    std::array<Value, maxArgs> values = {};
+    std::array<char, 96> text = {};
+
+    void add(std::string_view value);
+    void add(const char *value) { add(std::string_view(value)); }
+    void add(const std::string &value) { add(std::string_view(value)); }
+    template <std::floating_point T> void add(T value) {
+      kinds[count] = Kind::Float;
+      values[count++].f = value;
+    }
+    template <std::signed_integral T> void add(T value) {
+      kinds[count] = Kind::Int;
+      values[count++].i = value;
+    }
+    template <std::unsigned_integral T> void add(T value) {
+      kinds[count] = Kind::Unsigned;
+      values[count++].u = value;
+    }
+  };
+  using Queue = MpscQueue<Record, 1024>;
+
+  bool allow(LogLevel level);
+  void push(const Record &record);
+  void flush();
+  void write(const Record &record);
+
+  // each level's next free slot for a message, in ticks of `steady_clock`.
+  std::array<std::atomic<int64_t>, 4> nextAllowed = {};
+  std::atomic<int64_t> interval = 0, burst = 0;
+  std::atomic<size_t> dropped = 0;
+  std::atomic<bool> stopping = false, stopped = false;
+  std::unique_ptr<Queue> queue;
+  std::thread writer;
+  FILE *out = stderr;
+};
+
+// the log for the whole game.
+Logger &logger();
+
+template <typename... Args>
+void logDebug(const char *format, const Args &...args) {
+  logger().log(LogLevel::Debug, format, args...);
+}
+template <typename... Args>
+void logInfo(const char *format, const Args &...args) {
+  logger().log(LogLevel::Info, format, args...);
+}
+template <typename... Args>
+void logWarning(const char *format, const Args &...args) {
+  logger().log(LogLevel::Warning, format, args...);
+}
+template <typename... Args>
+void logError(const char *format, const Args &...args) {
+  logger().log(LogLevel::Error, format, args...);
+}
+
+} // namespace boom_tetris
@@ -1,29 +1,41 @@
 #include "rayui.hpp"
 #include "tetris.hpp"
+#include "versus.hpp"
+#include "netplay.hpp"
+#include "simulation.hpp"
+#include "timestep.hpp"
+#include "latency.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <functional>
 #include <raylib.h>
 #include <string>
+#include <thread>
 
 using namespace rayui;
 using namespace boom_tetris;
 
 struct UI
 {
-  Grid titleGrid = {{23, 23}};
-  Grid mainMenuGrid = {{23, 23}};
-  Grid gameOverGrid = {{24, 24}};
-  Grid settingsGrid = {{23, 23}};
+  // every menu lives as long as the game, so they all share one arena.
+  Arena arena;
+  Grid titleGrid = {arena, {23, 23}};
+  Grid mainMenuGrid = {arena, {23, 23}};
+  Grid gameOverGrid = {arena, {24, 24}};
+  Grid settingsGrid = {arena, {23, 23}};
   Style buttonStyle = Style{BLACK, WHITE, BLACK, 3};
-  Grid controlsGrid = {{23, 23}};
+  Grid controlsGrid = {arena, {23, 23}};
+  Grid versusGrid = {arena, {23, 23}};
 
-  std::vector<std::shared_ptr<Button>> levelButtons;
+  std::vector<Button *> levelButtons;
 
   bool shiftModifier = false;
 
-  Texture2D titleImage = LoadTexture("res/title.png");
-  std::vector<Texture2D> titleAnimationFrames = {};
+  // the title image comes from the assets' atlas.
+  std::shared_ptr<Assets> assets;
 
   enum struct Menu
   {
@@ -32,9 +44,10 @@ struct UI
     Settings,
     GameOver,
     Controls,
+    Versus,
   } menu = Menu::Controls;
 
-  int drawMenu(Game &game)
+  int drawMenu(Game &game, FrameTiming timing = {})
   {
 
     bool lastModifier = shiftModifier;
@@ -56,9 +69,9 @@ struct UI
       }
     }
 
-    ClearBackground(BLACK);
+    drawList().clearBackground(BLACK);
     LayoutState state = {{0, 0},
-                         {(float)GetScreenWidth(), (float)GetScreenHeight()}};
+                         {(float)drawList().width, (float)drawList().height}};
     switch (menu)
     {
     case Menu::Title:
@@ -78,40 +91,45 @@ struct UI
     break;
     case Menu::GameOver:
     {
-      game.drawGame();
+      game.drawGame(timing);
       gameOverGrid.draw(state);
     }
     break;
     case Menu::Controls:
       controlsGrid.draw(state);
       break;
+    case Menu::Versus:
+      versusGrid.draw(state);
+      break;
     }
 
     return true;
   }
 
-  UI(Game &game)
+  UI(Game &game, Versus &versus) : assets(game.assets)
   {
     setupMainMenu(game);
+    setupVersusMenu(game, versus);
     setupGameOver(game);
     setupTitleMenu();
     setupSettingsMenu(game);
     setupControlsGrid();
-    // these have to be backwards.
-    // todo: setup this animtaion
-    auto paths = std::vector<std::string>{};
-    for (const auto &path : paths)
-    {
-      titleAnimationFrames.push_back(LoadTexture(path.c_str()));
-    }
+    // todo: setup this animtaion. it's frames go in the assets' atlas next to
+    // the title, and play in an `AnimatedImage`.
   }
 
-  void addTitleImageAnimation(rayui::Grid &grid)
+  // the title image never changes, so it's drawn once into a layer.
+  rayui::Image *addTitleImageAnimation(rayui::Grid &grid)
   {
-    auto image = grid.emplace_element<rayui::Image>(
-        Position{0, 0}, grid.subdivisions, titleImage);
+    auto layer = grid.emplace_element<Layer>(Position{0, 0}, grid.subdivisions);
+    layer->subdivisions = grid.subdivisions;
+    layer->style.background = BLACK;
+    auto image = layer->emplace_element<rayui::Image>(
+        Position{0, 0}, grid.subdivisions, assets->atlas.texture,
+        assets->titleSource);
     image->fillType = rayui::FillType::FillVertical;
     image->hAlignment = HAlignment::Center;
+    return image;
   }
 
   void setupSettingsMenu(Game &game)
@@ -145,8 +163,17 @@ struct UI
       bagelButton->style.background = game.bagelMode ? GREEN : RED;
     };
 
+    auto turboButton = settingsGrid.emplace_element<Button>(
+        Position{8, 13}, Size{7, 2}, "Toggle Turbo", []() {}, buttonStyle);
+    turboButton->style.background = RED;
+    turboButton->onClicked = [turboButton, &game]()
+    {
+      game.turbo = !game.turbo;
+      turboButton->style.background = game.turbo ? GREEN : RED;
+    };
+
     auto pos = Position{9, 18};
-    auto btn = settingsGrid.emplace_element<Button>(
+    settingsGrid.emplace_element<Button>(
         pos, Size{5, 2}, "Back", [this]()
         { this->menu = Menu::Title; },
         buttonStyle);
@@ -188,7 +215,7 @@ struct UI
                                        Style{GetColor(0x1b1b1bcc), WHITE},
                                        LayoutKind::StretchHorizontal);
 
-    auto label = mainMenuGrid.emplace_element<Label>(
+    mainMenuGrid.emplace_element<Label>(
         Position{3, 19}, Size{1, 1}, "Level:", WHITE);
 
     mainMenuGrid.emplace_element<Label>(Position{17, 19}, Size{1, 1},
@@ -200,6 +227,7 @@ struct UI
       auto btnPos = Position{24 / 3 - 2 + i * size.width, pos.y - 2};
       auto callback = std::function<void()>([&, i = int(i)]()
                                             {
+        game.mode = Game::Mode::Normal;
         game.reset();
         const int level = shiftModifier ? i + 10 : i;
         game.startLevel = level;
@@ -221,7 +249,7 @@ struct UI
       levelButtons.push_back(button);
     }
 
-    auto backButton = mainMenuGrid.emplace_element<Button>(
+    mainMenuGrid.emplace_element<Button>(
         Position{0, 20}, Size{2, 2}, "Back", [&]()
         { menu = Menu::Title; },
         buttonStyle);
@@ -240,12 +268,64 @@ struct UI
         },
         buttonStyle);
     fortyLineBtn->fontSize = 18;
+
+    auto digBtn = mainMenuGrid.emplace_element<Button>(
+        Position{17, 20}, Size{2, 2}, "Dig",
+        [&]()
+        {
+          game.mode = Game::Mode::Dig;
+          game.reset();
+          game.level = 5;
+          game.startLevel = 5;
+          game.scene = Game::Scene::InGame;
+          game.gravity = game.gravityLevels[game.level];
+        },
+        buttonStyle);
+    digBtn->fontSize = 18;
+
+    auto versusBtn = mainMenuGrid.emplace_element<Button>(
+        Position{17, 22}, Size{5, 1}, "Versus",
+        [&]()
+        { menu = Menu::Versus; },
+        buttonStyle);
+    versusBtn->fontSize = 18;
   }
-  void setupControlsGrid()
+  void setupVersusMenu(Game &game, Versus &versus)
   {
-    addTitleImageAnimation(controlsGrid);
+    addTitleImageAnimation(versusGrid);
+
+    versusGrid.emplace_element<Rect>(Position{0, 19}, Size{1, 4},
+                                     Style{GetColor(0x1b1b1bcc), WHITE},
+                                     LayoutKind::StretchHorizontal);
+
+    versusGrid.emplace_element<Label>(Position{3, 19}, Size{1, 1},
+                                      "Boards:", WHITE);
+    versusGrid.emplace_element<Label>(
+        Position{3, 22}, Size{1, 1},
+        "keyboard & gamepads play, bots fill the rest. [Esc]: leave", WHITE);
 
-    auto image = std::dynamic_pointer_cast<rayui::Image>(controlsGrid.elements.back());
+    for (int boards = Versus::minBoards; boards <= Versus::maxBoards; ++boards)
+    {
+      auto button = versusGrid.emplace_element<Button>(
+          Position{6 + (boards - Versus::minBoards) * 2, 20}, Size{2, 2},
+          std::to_string(boards),
+          [&, boards]()
+          {
+            versus.start(boards, (uint64_t)time(0));
+            game.scene = Game::Scene::Versus;
+          },
+          buttonStyle);
+      button->margin = {3, 3, 3, 3};
+    }
+
+    versusGrid.emplace_element<Button>(
+        Position{0, 20}, Size{2, 2}, "Back", [&]()
+        { menu = Menu::Main; },
+        buttonStyle);
+  }
+  void setupControlsGrid()
+  {
+    auto image = addTitleImageAnimation(controlsGrid);
     image->style.foreground = Color{100, 100, 100, 255};
 
     controlsGrid.emplace_element<Label>(
@@ -260,7 +340,7 @@ struct UI
         Position{2, 16}, Size{7, 1}, "[Shift + click level button]: in menu, enter 'level + 10'", WHITE);
 
 
-    auto button = controlsGrid.emplace_element<Button>(
+    controlsGrid.emplace_element<Button>(
         Position{10, 18}, Size{3, 2}, "enter", [&]
         { menu = Menu::Title; }, buttonStyle);
   }
@@ -317,9 +397,9 @@ struct UI
 
 // TODO: figure out why, even though we get a valid gamepad 0, we never can
 // query buttons properly.
-void gamepadLogger(Game &game)
+void gamepadLogger(const InputDevices &devices)
 {
-  auto gamepad = game.findGamepad();
+  auto gamepad = devices.gamepads().empty() ? -1 : devices.gamepads()[0];
   system("clear");
   printf("gamepad: %d:\n", gamepad);
   for (int i = GAMEPAD_BUTTON_LEFT_FACE_UP; i <= GAMEPAD_BUTTON_RIGHT_THUMB;
@@ -338,62 +418,45 @@ Color RandomColor()
   return Color{r, g, b, a};
 }
 
-struct FallingRect
-{
-  Rectangle rect;
-  Color color;
-  float speed;
-};
-
 void pauseMenu()
 {
   static auto color = WHITE;
   static int ctr = 0;
-  static std::vector<FallingRect> fallingRects;
-  static bool initialized = false;
-
-  if (!initialized)
+  // squares raining down the screen, in pixels.
+  static Particles rain = []
   {
-    for (int i = 0; i < 100; i++)
-    {
-      FallingRect newRect;
-      newRect.rect.x = GetRandomValue(0, GetScreenWidth() - 20);
-      newRect.rect.y = GetRandomValue(-200, -50);
-      newRect.rect.width = GetRandomValue(20, 100);
-      newRect.rect.height = GetRandomValue(20, 100);
-      newRect.color = RandomColor();
-      newRect.speed = GetRandomValue(2, 5);
-      fallingRects.push_back(newRect);
-    }
-    initialized = true;
-  }
-
-  // Update and draw falling rectangles
-  for (auto &rect : fallingRects)
-  {
-    // Update position
-    rect.rect.y += rect.speed;
-
-    // Draw rectangle
-    DrawRectangleRec(rect.rect, rect.color);
-
-    // Reset if it goes off screen
-    if (rect.rect.y > GetScreenHeight())
-    {
-      rect.rect.x = GetRandomValue(0, GetScreenWidth() - 20);
-      rect.rect.y =
-          GetRandomValue(-200, -50); // Reset to start above the screen
-      rect.rect.width = GetRandomValue(20, 100);
-      rect.rect.height = GetRandomValue(20, 100);
-      rect.color = RandomColor();
-      rect.speed = GetRandomValue(2, 5);
-    }
-  }
+    Particles particles;
+    particles.rng = Rng(time(0));
+    particles.fadeTime = 0;
+    return particles;
+  }();
+
+  const auto width = (float)drawList().width;
+  const auto height = (float)drawList().height;
+  rain.bottom = height + 50;
+  // a steady 180 a second keeps the screen about as full as it falls, however
+  // fast frames come. what's left of one carries over to the next frame. the
+  // frame time is capped, the loop slows right down in the background.
+  static float due = 0;
+  const auto seconds = std::min(GetFrameTime(), 0.1f);
+  due += 180 * seconds;
+  const auto count = (size_t)due;
+  due -= count;
+  rain.emit(count, {.area = {0, -200, width, 150},
+                    .minVelocity = {0, 120},
+                    .maxVelocity = {0, 300},
+                    .minSize = 10,
+                    .maxSize = 50,
+                    .minLife = 60,
+                    .maxLife = 60});
+  rain.update(seconds);
+
+  drawList().clearBackground(BLACK);
+  rain.draw(drawList());
   auto size = MeasureText("Paused", 48);
-  auto screenH = GetScreenHeight() / 2 - (size / 2),
-       screenW = GetScreenWidth() / 2 - (size / 2);
-  ClearBackground(BLACK);
-  DrawText("Paused", screenW, screenH, 48, color);
+  auto screenH = drawList().height / 2 - (size / 2),
+       screenW = drawList().width / 2 - (size / 2);
+  drawList().text("Paused", screenW, screenH, 48, color);
   ctr++;
   if (ctr > 60)
   {
@@ -402,6 +465,68 @@ void pauseMenu()
     ctr = 0;
   }
 }
+// how often the loop runs while nobody's looking at the window.
+constexpr int idleFps = 10;
+
+// menus only change when something happens, so they wait for input instead of
+// drawing 60 times a second, and everything slows down while the window is in
+// the background. online matches keep going at full speed, the other player
+// is still playing. a menu with particles still flying over it keeps drawing
+// until they're gone.
+// otherwise frames are drawn as fast as `cap`, the display's refresh rate
+// unless it's been set, whatever rate the game ticks at.
+struct Pacing
+{
+  bool waiting = false;
+  int fps = 60;
+  // 0 draws as fast as it can.
+  int cap = 60;
+
+  void update(Game::Scene scene, bool idle, bool animating)
+  {
+    bool menu =
+        (scene == Game::Scene::MainMenu || scene == Game::Scene::GameOver) &&
+        !animating;
+    if (menu != waiting)
+    {
+      // EndDrawing sleeps until there's input, a resize or the like.
+      menu ? EnableEventWaiting() : DisableEventWaiting();
+      waiting = menu;
+    }
+    int target = idle && scene != Game::Scene::Online ? idleFps : cap;
+    if (target != fps)
+    {
+      SetTargetFPS(target);
+      fps = target;
+    }
+  }
+};
+
+// with --late-input, input is polled again right before the next tick's due,
+// so the tick acts on what's held then instead of when the frame started. it
+// doesn't wait when another frame starts before then anyway. raylib only
+// polls in EndDrawing, and a second poll forgets the keys that just went down,
+// so it's skipped when the first poll saw a key the menus use.
+static bool pollLate(LatencyMeter::Clock::time_point due, int fps)
+{
+  auto now = LatencyMeter::Clock::now();
+  if (fps > 0 && due - now > std::chrono::duration<double>(1.0 / fps))
+  {
+    return false;
+  }
+  if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_ENTER) ||
+      IsKeyPressed(KEY_F3) || IsKeyPressed(KEY_F4))
+  {
+    return false;
+  }
+  {
+    Profiler::Scope scope(Phase::Wait);
+    std::this_thread::sleep_until(due);
+  }
+  PollInputEvents();
+  return true;
+}
+
 int main(int argc, char *argv[])
 {
   srand(time(0));
@@ -423,13 +548,208 @@ int main(int argc, char *argv[])
     return 0;
   }
 
+  // these can go before any of the other options, in any order.
+  //   --fps <n> caps how often frames are drawn, 0 for no cap.
+  //   --late-input polls input right before each tick, see pollLate.
+  //   --latency-log <path> writes how long each press took to show up.
+  //   --profile-log <path> writes how long each part of each frame took.
+  //   --trace <path> writes what happened when, see Tracer.
+  //   --log-level <debug|info|warning|error> logs less, or more.
+  Pacing pacing;
+  auto refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+  pacing.cap = refreshRate > 0 ? refreshRate : 60;
+  bool lateInput = false;
+  const char *latencyLog = nullptr;
+  const char *profileLog = nullptr;
+  while (argc >= 2)
+  {
+    std::string option = argv[1];
+    int used = 0;
+    if (option == "--fps" && argc >= 3)
+    {
+      pacing.cap = std::max(0, std::atoi(argv[2]));
+      used = 2;
+    }
+    else if (option == "--late-input")
+    {
+      lateInput = true;
+      used = 1;
+    }
+    else if (option == "--latency-log" && argc >= 3)
+    {
+      latencyLog = argv[2];
+      used = 2;
+    }
+    else if (option == "--profile-log" && argc >= 3)
+    {
+      profileLog = argv[2];
+      used = 2;
+    }
+    else if (option == "--log-level" && argc >= 3)
+    {
+      std::string level = argv[2];
+      logger().level = level == "debug"     ? LogLevel::Debug
+                       : level == "warning" ? LogLevel::Warning
+                       : level == "error"   ? LogLevel::Error
+                                            : LogLevel::Info;
+      used = 2;
+    }
+    else if (option == "--trace" && argc >= 3)
+    {
+      if (!tracer().start(argv[2]))
+      {
+        printf("can't write trace '%s'\n", argv[2]);
+      }
+      tracer().nameThread("window");
+      used = 2;
+    }
+    else
+    {
+      break;
+    }
+    argc -= used;
+    argv += used;
+  }
+
+  // after the options, so loading the sounds can be traced.
   Game game = Game();
-  UI ui = UI(game);
+  Versus versus = Versus(game.assets);
+  UI ui = UI(game, versus);
+
+  // boom_tetris --netplay <port> <peer ip:port> [latency ms] [loss %]
+  // goes straight into an online match. the latency and loss are made up, to
+  // try it out over localhost.
+  std::unique_ptr<Netplay> netplay;
+  if (argc >= 4 && std::string(argv[1]) == "--netplay")
+  {
+    auto port = (uint16_t)std::atoi(argv[2]);
+    auto peer = parseAddress(argv[3]);
+    if (!peer)
+    {
+      printf("can't read peer address '%s'\n", argv[3]);
+      return 1;
+    }
+    netplay = std::make_unique<Netplay>(game.assets, port, *peer,
+                                        Rng(time(0) + port).next());
+    if (argc >= 5)
+    {
+      netplay->connection.latency = std::chrono::milliseconds(std::atoi(argv[4]));
+    }
+    if (argc >= 6)
+    {
+      netplay->connection.lossPercent = std::atoi(argv[5]);
+    }
+    game.scene = Game::Scene::Online;
+  }
 
+  // everything is recorded into rayui's draw list, and put on screen by the
+  // backend at the end of the frame.
+  RaylibBackend backend;
+  // the game ticks at it's own rate, however fast frames are drawn. a solo
+  // game ticks on a thread of it's own, the rest on this one.
+  Simulation simulation(game.assets);
+  FixedTimestep ticker(Game::tickRate);
+  double lastFrame = GetTime();
+  // F3 shows how long presses take to get on screen, and F4 where each
+  // frame's time goes.
+  LatencyMeter latency;
+  // a press on this thread waits for the first tick that takes it.
+  InputFrame lastInput;
+  // every key and button's read here once a frame, and handed out from
+  // there.
+  InputDevices devices;
+  if (!devices.bindings.read())
+  {
+    // so there's a file to change them in.
+    devices.bindings.write();
+  }
+  versus.devices = &devices;
+  std::optional<LatencyMeter::Clock::time_point> pressPending;
   while (!WindowShouldClose())
   {
-    BeginDrawing();
-    ClearBackground(BG_COLOR);
+    // EndDrawing just polled.
+    auto polled = LatencyMeter::Clock::now();
+    bool minimized = IsWindowMinimized();
+    bool idle = minimized || !IsWindowFocused();
+    bool solo = game.scene == Game::Scene::InGame && !idle;
+    bool online = game.scene == Game::Scene::Online;
+    InputFrame input;
+    // the games are played from what's held, so both polls count, and a tap
+    // in between isn't lost.
+    {
+      Profiler::Scope scope(Phase::Input);
+      devices.update();
+      if (IsKeyPressed(KEY_F3))
+      {
+        latency.visible = !latency.visible;
+      }
+      if (IsKeyPressed(KEY_F4))
+      {
+        profiler().visible = !profiler().visible;
+      }
+      if (solo || online)
+      {
+        input = devices.player();
+      }
+      if (!online)
+      {
+        pressPending.reset();
+      }
+      if (lateInput && !minimized && solo && simulation.running())
+      {
+        // a little early, for the simulation's thread to get it in time.
+        auto due = simulation.nextTick() - std::chrono::microseconds(1500);
+        if (pollLate(due, pacing.fps))
+        {
+          simulation.setInput(input, polled);
+          devices.update();
+          input = devices.player();
+          polled = LatencyMeter::Clock::now();
+        }
+      }
+      else if (lateInput && online)
+      {
+        // just after, so this frame runs the tick.
+        auto wait = ticker.step - ticker.accumulator - (GetTime() - lastFrame);
+        auto due = LatencyMeter::Clock::now() +
+                   std::chrono::duration_cast<LatencyMeter::Clock::duration>(
+                       std::chrono::duration<double>(wait + 0.0002));
+        if (pollLate(due, pacing.fps))
+        {
+          devices.update();
+          auto late = devices.player();
+          // a press is timed from the poll that saw it first.
+          if (!(input.held & ~lastInput.held))
+          {
+            polled = LatencyMeter::Clock::now();
+          }
+          late.held |= input.held;
+          input = late;
+        }
+      }
+    }
+
+    double now = GetTime();
+    int ticks = ticker.advance(now - lastFrame);
+    // after a wait for input, effects pick up where they were.
+    FrameTiming timing = {ticker.alpha(),
+                          (float)std::min(now - lastFrame, 0.1)};
+    lastFrame = now;
+    // the game over screen draws the game under it, particles and all.
+    pacing.update(game.scene, idle,
+                  game.scene == Game::Scene::GameOver &&
+                      !game.particles.empty());
+
+    // quitting or losing leaves the game, there's nothing left to play.
+    if (game.scene != Game::Scene::InGame)
+    {
+      simulation.stop();
+    }
+
+    // games ticked on this thread while drawing are timed on their own.
+    std::optional<Profiler::Scope> drawing(std::in_place, Phase::Draw);
+    drawList().reset(GetScreenWidth(), GetScreenHeight());
+    drawList().clearBackground(BG_COLOR);
     switch (game.scene)
     {
     case Game::Scene::MainMenu:
@@ -440,7 +760,7 @@ int main(int argc, char *argv[])
     case Game::Scene::GameOver:
     {
       ui.menu = UI::Menu::GameOver;
-      ui.drawMenu(game);
+      ui.drawMenu(game, timing);
       break;
     }
     case Game::Scene::InGame:
@@ -449,22 +769,117 @@ int main(int argc, char *argv[])
       {
         game.paused = !game.paused;
       }
+      // nobody plays a window they've switched away from.
+      if (idle)
+      {
+        game.paused = true;
+      }
       if (game.paused)
       {
+        simulation.stop();
         pauseMenu();
       }
       else
       {
-        game.processGameLogic();
-        game.drawGame();
+        // the game itself runs on the simulation's thread, this just shows
+        // it.
+        simulation.setInput(input, polled);
+        timing.alpha = simulation.present(game);
+        if (simulation.pressShown)
+        {
+          latency.shown(*simulation.pressShown);
+        }
+        game.drawGame(timing);
+      }
+      break;
+    }
+    case Game::Scene::Versus:
+    {
+      if (IsKeyPressed(KEY_ESCAPE) ||
+          (versus.winner && IsKeyPressed(KEY_ENTER)))
+      {
+        game.scene = Game::Scene::MainMenu;
+        ui.menu = UI::Menu::Versus;
+      }
+      else
+      {
+        // the match holds while the window's in the background.
+        for (int i = 0; i < ticks && !idle; ++i)
+        {
+          versus.processGameLogic();
+        }
+        versus.draw(timing);
+      }
+      break;
+    }
+    case Game::Scene::Online:
+    {
+      if (IsKeyPressed(KEY_ESCAPE) ||
+          (netplay->versus.winner && IsKeyPressed(KEY_ENTER)))
+      {
+        netplay.reset();
+        game.scene = Game::Scene::MainMenu;
+        ui.menu = UI::Menu::Main;
+      }
+      else
+      {
+        if (input.held & ~lastInput.held && !pressPending)
+        {
+          pressPending = polled;
+        }
+        lastInput = input;
+        for (int i = 0; i < ticks; ++i)
+        {
+          netplay->update(input);
+        }
+        if (ticks > 0 && pressPending)
+        {
+          latency.shown(*pressPending);
+          pressPending.reset();
+        }
+        if (!minimized)
+        {
+          netplay->draw(timing);
+        }
       }
       break;
     }
     }
+    latency.draw(drawList());
+    profiler().draw(drawList());
+    drawing.emplace(Phase::Present);
+    BeginDrawing();
+    // a minimized window isn't seen, there's no point drawing it.
+    if (!minimized)
+    {
+      ClearBackground(BG_COLOR);
+      backend.present(drawList());
+    }
     EndDrawing();
+    // EndDrawing waits out the frame cap after swapping, so with a cap this
+    // counts a little too long.
+    latency.presented();
+    drawing.reset();
+    profiler().endFrame();
   }
 
+  if (latencyLog && !latency.writeCsv(latencyLog))
+  {
+    printf("can't write latency log '%s'\n", latencyLog);
+  }
+  if (profileLog && !profiler().writeCsv(profileLog))
+  {
+    printf("can't write profile log '%s'\n", profileLog);
+  }
+  simulation.stop();
+  tracer().stop();
+  if (tracer().dropped() > 0)
+  {
+    printf("the trace is missing %zu events, they came too fast\n",
+           tracer().dropped());
+  }
   game.scoreFile.write();
+  logger().stop();
   CloseAudioDevice();
   return 0;
 }
\ No newline at end of file
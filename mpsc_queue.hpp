@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace boom_tetris {
+
+// a fixed size queue any number of threads can push into, and one other
+// thread pops from, with no locks. each slot counts which lap around the
+// queue it's on, so a pusher knows when it's free and the popper knows when
+// it's been filled. like `SpscQueue`, a push into a full queue just fails.
+template <typename T, size_t Capacity> class MpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "the capacity has to be a power of two");
+
+public:
+  MpscQueue() {
+    for (size_t i = 0; i < Capacity; ++i) {
+      slots[i].lap.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool push(const T &value) {
+    auto tail = this->tail.load(std::memory_order_relaxed);
+    while (true) {
+      auto &slot = slots[tail % Capacity];
+      auto lap = slot.lap.load(std::memory_order_acquire);
+      if (lap == tail) {
+        // free, as long as nobody else claims it first.
+        if (this->tail.compare_exchange_weak(tail, tail + 1,
+                                             std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.lap.store(tail + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lap < tail) {
+        // still full from the lap before.
+        return false;
+      } else {
+        tail = this->tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> pop() {
+    auto &slot = slots[head % Capacity];
+    if (slot.lap.load(std::memory_order_acquire) != head + 1) {
+      return std::nullopt;
+    }
+    T value = slot.value;
+    slot.lap.store(head + Capacity, std::memory_order_release);
+    head++;
+    return value;
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> lap;
+    T value;
+  };
+  std::array<Slot, Capacity> slots;
+  alignas(64) std::atomic<size_t> tail = 0;
+  // only the popping thread touches this.
+  alignas(64) size_t head = 0;
+};
+
+} // namespace boom_tetris
@@ -0,0 +1,157 @@
+#include "net.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socklen_t = int;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace boom_tetris;
+
+static void closeSocket(intptr_t handle) {
+#ifdef _WIN32
+  closesocket((SOCKET)handle);
+#else
+  close((int)handle);
+#endif
+}
+
+std::optional<Address> boom_tetris::parseAddress(const std::string &text) {
+  Address address;
+  auto colon = text.rfind(':');
+  auto portText = colon == std::string::npos ? text : text.substr(colon + 1);
+  if (colon != std::string::npos) {
+    in_addr ip;
+    if (inet_pton(AF_INET, text.substr(0, colon).c_str(), &ip) != 1) {
+      return std::nullopt;
+    }
+    address.ip = ntohl(ip.s_addr);
+  }
+  char *end = nullptr;
+  auto port = std::strtoul(portText.c_str(), &end, 10);
+  if (portText.empty() || *end != '\0' || port == 0 || port > 65535) {
+    return std::nullopt;
+  }
+  address.port = port;
+  return address;
+}
+
+UdpSocket::UdpSocket(uint16_t port) {
+#ifdef _WIN32
+  static bool started = [] {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+  }();
+  if (!started) {
+    return;
+  }
+#endif
+  auto fd = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+  if (fd == INVALID_SOCKET) {
+    return;
+  }
+#else
+  if (fd < 0) {
+    return;
+  }
+#endif
+  handle = (intptr_t)fd;
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  bool ok = bind(fd, (sockaddr *)&address, sizeof(address)) == 0;
+#ifdef _WIN32
+  u_long nonBlocking = 1;
+  ok = ok && ioctlsocket(fd, FIONBIO, &nonBlocking) == 0;
+#else
+  ok = ok && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+  if (!ok) {
+    closeSocket(handle);
+    handle = -1;
+  }
+}
+
+UdpSocket::~UdpSocket() {
+  if (valid()) {
+    closeSocket(handle);
+  }
+}
+
+bool UdpSocket::valid() const { return handle != -1; }
+
+void UdpSocket::send(const Address &to, std::span<const uint8_t> data) {
+  if (!valid()) {
+    return;
+  }
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(to.ip);
+  address.sin_port = htons(to.port);
+  sendto(handle, (const char *)data.data(), (int)data.size(), 0,
+         (sockaddr *)&address, sizeof(address));
+}
+
+std::optional<size_t> UdpSocket::receive(std::span<uint8_t> buffer,
+                                         Address &from) {
+  if (!valid()) {
+    return std::nullopt;
+  }
+  sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  auto size = recvfrom(handle, (char *)buffer.data(), (int)buffer.size(), 0,
+                       (sockaddr *)&address, &length);
+  if (size < 0) {
+    return std::nullopt;
+  }
+  from.ip = ntohl(address.sin_addr.s_addr);
+  from.port = ntohs(address.sin_port);
+  return size;
+}
+
+void Connection::send(std::span<const uint8_t> data, Clock::time_point now) {
+  if (lossPercent > 0 && (int)rng.below(100) < lossPercent) {
+    return;
+  }
+  if (latency.count() == 0 && jitter.count() == 0) {
+    socket.send(peer, data);
+    return;
+  }
+  auto delay = latency + std::chrono::milliseconds(
+                             rng.below((uint32_t)jitter.count() + 1));
+  delayed.push_back({now + delay, {data.begin(), data.end()}});
+}
+
+void Connection::flush(Clock::time_point now) {
+  // jitter can leave them out of order, which is fine: so can the internet.
+  for (auto it = delayed.begin(); it != delayed.end();) {
+    if (it->due <= now) {
+      socket.send(peer, it->data);
+      it = delayed.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::optional<size_t> Connection::receive(std::span<uint8_t> buffer) {
+  Address from;
+  while (auto size = socket.receive(buffer, from)) {
+    // anything not from the peer is noise.
+    if (from == peer) {
+      return size;
+    }
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "randomizer.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace boom_tetris {
+
+// an ipv4 address and port, in host byte order.
+struct Address {
+  uint32_t ip = 0x7f000001; // 127.0.0.1
+  uint16_t port = 0;
+
+  bool operator==(const Address &) const = default;
+};
+
+// "1.2.3.4:5678" or just a port, which means localhost.
+std::optional<Address> parseAddress(const std::string &text);
+
+// a non-blocking udp socket.
+struct UdpSocket {
+  // binds to `port` on every interface. check `valid` to see if it worked.
+  explicit UdpSocket(uint16_t port);
+  ~UdpSocket();
+  UdpSocket(const UdpSocket &) = delete;
+  UdpSocket &operator=(const UdpSocket &) = delete;
+
+  bool valid() const;
+  void send(const Address &to, std::span<const uint8_t> data);
+  // the size of the next waiting datagram, copied into `buffer`, or nothing
+  // if there isn't one.
+  std::optional<size_t> receive(std::span<uint8_t> buffer, Address &from);
+
+private:
+  intptr_t handle = -1;
+};
+
+// a udp link to one peer that can pretend to be a worse network than it is:
+// outgoing packets are held back by `latency` plus up to `jitter`, and
+// dropped `lossPercent` of the time. both ends applying it doubles the round
+// trip, like a real bad connection would.
+struct Connection {
+  using Clock = std::chrono::steady_clock;
+
+  UdpSocket socket;
+  Address peer;
+
+  std::chrono::milliseconds latency{0};
+  std::chrono::milliseconds jitter{0};
+  int lossPercent = 0;
+
+  Connection(uint16_t port, Address peer) : socket(port), peer(peer) {}
+
+  void send(std::span<const uint8_t> data, Clock::time_point now);
+  // put out every held back packet that's due by `now`.
+  void flush(Clock::time_point now);
+  // the size of the next packet from the peer, or nothing.
+  std::optional<size_t> receive(std::span<uint8_t> buffer);
+
+private:
+  struct Delayed {
+    Clock::time_point due;
+    std::vector<uint8_t> data;
+  };
+  std::deque<Delayed> delayed;
+  Rng rng{0x5eed};
+};
+
+} // namespace boom_tetris
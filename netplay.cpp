@@ -0,0 +1,279 @@
+#include "netplay.hpp"
+#include <algorithm>
+#include <string>
+
+using namespace boom_tetris;
+
+namespace {
+
+enum struct PacketType : uint8_t { Hello = 1, Inputs = 2 };
+
+// every packet is small, so it's built and read in a fixed buffer.
+struct PacketWriter {
+  std::array<uint8_t, 256> data;
+  size_t size = 0;
+
+  void u8(uint8_t value) { data[size++] = value; }
+  void u32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      u8(value >> (i * 8));
+    }
+  }
+  void u64(uint64_t value) {
+    u32(value);
+    u32(value >> 32);
+  }
+  std::span<const uint8_t> bytes() const { return {data.data(), size}; }
+};
+
+// reading past the end gives zeroes and clears `ok`, so a short packet can be
+// read in full and thrown away after.
+struct PacketReader {
+  std::span<const uint8_t> data;
+  bool ok = true;
+
+  uint8_t u8() {
+    if (data.empty()) {
+      ok = false;
+      return 0;
+    }
+    auto value = data[0];
+    data = data.subspan(1);
+    return value;
+  }
+  uint32_t u32() {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      value |= (uint32_t)u8() << (i * 8);
+    }
+    return value;
+  }
+  uint64_t u64() {
+    uint64_t low = u32();
+    return low | (uint64_t)u32() << 32;
+  }
+};
+
+} // namespace
+
+Netplay::Netplay(std::shared_ptr<Assets> assets, uint16_t port, Address peer,
+                 uint64_t seed)
+    : versus(std::move(assets)), connection(port, peer), port(port),
+      localSeed(seed) {}
+
+void Netplay::start(uint64_t remoteSeed, uint16_t remotePort) {
+  // both sides work out the same seed and who's player one from the same two
+  // hellos.
+  bool first = localSeed != remoteSeed ? localSeed < remoteSeed
+                                       : port < remotePort;
+  localPlayer = first ? 0 : 1;
+
+  std::vector<Versus::Player> players(2);
+  players[localPlayer].controller = Versus::Controller::Keyboard;
+  players[1 - localPlayer].controller = Versus::Controller::Remote;
+  versus.start(std::move(players), localSeed ^ remoteSeed);
+  state = State::Playing;
+}
+
+void Netplay::update(InputFrame input, Clock::time_point now) {
+  connection.flush(now);
+  receive(now);
+
+  if (state == State::Connecting) {
+    sendHello(now);
+    return;
+  }
+
+  if (rollbackFrom < frame) {
+    rollback();
+  }
+
+  // too far ahead of the other side to be able to fix things up when their
+  // inputs come in, wait for them to catch up.
+  stalled = frame - confirmedFrame > maxRollback;
+  if (stalled) {
+    stats.stalls++;
+  } else {
+    localInputs[frame % historySize] = input;
+    simulate(frame);
+    frame++;
+  }
+  compareChecksums();
+  sendInputs(now);
+}
+
+void Netplay::receive(Clock::time_point now) {
+  std::array<uint8_t, 512> buffer;
+  while (auto size = connection.receive(buffer)) {
+    PacketReader packet{std::span(buffer).first(*size)};
+    auto type = (PacketType)packet.u8();
+
+    if (type == PacketType::Hello) {
+      auto remoteSeed = packet.u64();
+      if (!packet.ok) {
+        continue;
+      }
+      if (state == State::Connecting) {
+        start(remoteSeed, connection.peer.port);
+      } else {
+        // they haven't heard us yet.
+        sendHello(now);
+      }
+    } else if (type == PacketType::Inputs) {
+      int first = packet.u32();
+      int count = packet.u8();
+      std::array<InputFrame, 256> inputs;
+      for (int i = 0; i < count; ++i) {
+        inputs[i].held = packet.u8();
+      }
+      int ack = packet.u32();
+      int checksumFrame = packet.u32();
+      auto checksum = packet.u64();
+      if (!packet.ok || state != State::Playing) {
+        continue;
+      }
+
+      for (int i = 0; i < count; ++i) {
+        int f = first + i;
+        // older ones we have, and we can't use any after a gap yet.
+        if (f != confirmedFrame + 1) {
+          continue;
+        }
+        // don't let inputs from too far ahead wrap over ones still needed.
+        if (f - frame >= historySize - maxRollback - 1) {
+          break;
+        }
+        remoteInputs[f % historySize] = inputs[i];
+        confirmedFrame = f;
+        if (f < frame && inputs[i].held != predictedInputs[f % historySize].held) {
+          rollbackFrom = std::min(rollbackFrom, f);
+        }
+      }
+      remoteAckFrame = std::max(remoteAckFrame, ack);
+      if (checksumFrame > remoteChecksumFrame) {
+        remoteChecksumFrame = checksumFrame;
+        remoteChecksum = checksum;
+      }
+    }
+  }
+}
+
+void Netplay::rollback() {
+  auto started = Clock::now();
+
+  // the frames being played again were already heard and seen the first time.
+  std::array<bool, 2> silent, effects, traced;
+  for (int p = 0; p < 2; ++p) {
+    silent[p] = versus.players[p].game->silent;
+    effects[p] = versus.players[p].game->effects;
+    traced[p] = versus.players[p].game->traced;
+    versus.players[p].game->silent = true;
+    versus.players[p].game->effects = false;
+    versus.players[p].game->traced = false;
+  }
+
+  const auto &from = saved[rollbackFrom % historySize];
+  for (int p = 0; p < 2; ++p) {
+    versus.players[p].game->load(from.games[p]);
+  }
+  versus.winner = from.winner;
+  for (int f = rollbackFrom; f < frame; ++f) {
+    simulate(f);
+  }
+
+  for (int p = 0; p < 2; ++p) {
+    versus.players[p].game->silent = silent[p];
+    versus.players[p].game->effects = effects[p];
+    versus.players[p].game->traced = traced[p];
+  }
+
+  auto took = Clock::now() - started;
+  stats.rollbacks++;
+  stats.resimulatedFrames += frame - rollbackFrom;
+  stats.deepestRollback = std::max(stats.deepestRollback, frame - rollbackFrom);
+  stats.rollbackTime += took;
+  stats.slowestRollback = std::max<std::chrono::nanoseconds>(
+      stats.slowestRollback, took);
+  rollbackFrom = INT_MAX;
+}
+
+void Netplay::simulate(int f) {
+  auto &snapshot = saved[f % historySize];
+  for (int p = 0; p < 2; ++p) {
+    versus.players[p].game->save(snapshot.games[p]);
+  }
+  snapshot.winner = versus.winner;
+  snapshot.checksum = versus.players[0].game->checksum() * 31 ^
+                      versus.players[1].game->checksum();
+
+  // guess they're still holding what they held last.
+  InputFrame remote;
+  if (f <= confirmedFrame) {
+    remote = remoteInputs[f % historySize];
+  } else if (confirmedFrame >= 0) {
+    remote = remoteInputs[confirmedFrame % historySize];
+  }
+  predictedInputs[f % historySize] = remote;
+
+  std::array<InputFrame, 2> inputs;
+  inputs[localPlayer] = localInputs[f % historySize];
+  inputs[1 - localPlayer] = remote;
+  versus.step(inputs);
+}
+
+void Netplay::compareChecksums() {
+  // both sides have to have settled the frame, and it has to still be saved.
+  auto f = remoteChecksumFrame;
+  if (f <= lastCheckedFrame || f > settledFrame() ||
+      f <= frame - historySize) {
+    return;
+  }
+  lastCheckedFrame = f;
+  stats.checksumsCompared++;
+  if (saved[f % historySize].checksum != remoteChecksum) {
+    stats.desyncs++;
+  }
+}
+
+void Netplay::sendHello(Clock::time_point now) {
+  PacketWriter packet;
+  packet.u8((uint8_t)PacketType::Hello);
+  packet.u64(localSeed);
+  connection.send(packet.bytes(), now);
+}
+
+void Netplay::sendInputs(Clock::time_point now) {
+  // every input they haven't acknowledged goes in every packet, so a lost
+  // packet costs nothing as long as one of the next ones arrives.
+  int first = std::max({remoteAckFrame + 1, frame - (historySize - 1), 0});
+  PacketWriter packet;
+  packet.u8((uint8_t)PacketType::Inputs);
+  packet.u32(first);
+  packet.u8(frame - first);
+  for (int f = first; f < frame; ++f) {
+    packet.u8(localInputs[f % historySize].held);
+  }
+  packet.u32(confirmedFrame);
+  auto settled = settledFrame();
+  packet.u32(settled);
+  packet.u64(settled >= 0 ? saved[settled % historySize].checksum : 0);
+  connection.send(packet.bytes(), now);
+}
+
+void Netplay::draw(FrameTiming timing) {
+  if (state == State::Connecting) {
+    auto text = "waiting for the other player on port " +
+                std::to_string(connection.peer.port) + "...";
+    rayui::drawList().text(text.c_str(), 20, rayui::drawList().height / 2, 24,
+                           WHITE);
+    return;
+  }
+  versus.draw(timing);
+  if (stalled) {
+    rayui::drawList().text("waiting for the other player...", 20, 20, 24,
+                           ORANGE);
+  }
+  if (stats.desyncs > 0) {
+    rayui::drawList().text("desynced!", 20, 50, 24, RED);
+  }
+}
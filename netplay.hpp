@@ -0,0 +1,94 @@
+#pragma once
+#include "net.hpp"
+#include "versus.hpp"
+#include <array>
+#include <chrono>
+#include <climits>
+#include <memory>
+
+namespace boom_tetris {
+
+// two player versus over udp with rollback. both boards are simulated here;
+// when the other player's input for a frame hasn't arrived yet it's guessed
+// to be whatever they held last, and if the real one turns out different,
+// both boards are put back to how they were on that frame and played forward
+// again with it. waiting on the network instead would add a round trip of
+// input lag, which at NES speeds isn't playable.
+struct Netplay {
+  using Clock = Connection::Clock;
+
+  // how many frames back a late input can still be fixed up from. any further
+  // ahead of the other player than this and we wait for them.
+  static constexpr int maxRollback = 12;
+  // frames of inputs and snapshots kept, enough for a full rollback window on
+  // both sides.
+  static constexpr int historySize = 32;
+  static_assert(historySize > 2 * maxRollback + 2);
+
+  enum struct State { Connecting, Playing } state = State::Connecting;
+
+  Versus versus;
+  Connection connection;
+  uint16_t port;
+  // each side picks a seed; the match is dealt from both combined.
+  uint64_t localSeed;
+  int localPlayer = 0;
+
+  // the next frame to be simulated.
+  int frame = 0;
+  // the other player's inputs are known up to and including this frame.
+  int confirmedFrame = -1;
+  // and they've told us they have ours up to this one.
+  int remoteAckFrame = -1;
+  // whether the last update had to wait for the other player.
+  bool stalled = false;
+
+  struct Stats {
+    size_t rollbacks = 0;
+    size_t resimulatedFrames = 0;
+    int deepestRollback = 0;
+    std::chrono::nanoseconds rollbackTime{0};
+    std::chrono::nanoseconds slowestRollback{0};
+    size_t stalls = 0;
+    size_t checksumsCompared = 0;
+    size_t desyncs = 0;
+  } stats;
+
+  Netplay(std::shared_ptr<Assets> assets, uint16_t port, Address peer,
+          uint64_t seed);
+
+  // call once a tick with what the local player is holding.
+  void update(InputFrame input, Clock::time_point now = Clock::now());
+  void draw(FrameTiming timing = {});
+
+private:
+  struct Saved {
+    std::array<Game::Snapshot, 2> games;
+    std::optional<int> winner;
+    uint64_t checksum = 0;
+  };
+  std::array<Saved, historySize> saved;
+  std::array<InputFrame, historySize> localInputs = {};
+  std::array<InputFrame, historySize> remoteInputs = {};
+  // the guess each frame was last simulated with.
+  std::array<InputFrame, historySize> predictedInputs = {};
+
+  // the earliest frame a late input showed was mispredicted.
+  int rollbackFrom = INT_MAX;
+  // the last checksum the other side sent, for a frame they've settled.
+  int remoteChecksumFrame = -1;
+  uint64_t remoteChecksum = 0;
+  int lastCheckedFrame = -1;
+
+  void start(uint64_t remoteSeed, uint16_t remotePort);
+  void receive(Clock::time_point now);
+  void rollback();
+  void simulate(int f);
+  void compareChecksums();
+  // the last frame every input before is known for, so it's state is final.
+  int settledFrame() const { return std::min(confirmedFrame + 1, frame - 1); }
+  void sendHello(Clock::time_point now);
+  void sendInputs(Clock::time_point now);
+};
+
+} // namespace boom_tetris
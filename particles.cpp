@@ -0,0 +1,93 @@
+#include "particles.hpp"
+#include <algorithm>
+
+using namespace boom_tetris;
+
+void Particles::clear() {
+  x.clear();
+  y.clear();
+  vx.clear();
+  vy.clear();
+  size.clear();
+  life.clear();
+  color.clear();
+}
+
+void Particles::emit(size_t count, const Emitter &emitter) {
+  count = std::min(count, limit - std::min(limit, this->count()));
+  for (size_t i = 0; i < count; ++i) {
+    x.push_back(uniform(emitter.area.x, emitter.area.x + emitter.area.width));
+    y.push_back(uniform(emitter.area.y, emitter.area.y + emitter.area.height));
+    vx.push_back(uniform(emitter.minVelocity.x, emitter.maxVelocity.x));
+    vy.push_back(uniform(emitter.minVelocity.y, emitter.maxVelocity.y));
+    size.push_back(uniform(emitter.minSize, emitter.maxSize));
+    life.push_back(uniform(emitter.minLife, emitter.maxLife));
+    if (emitter.palette.empty()) {
+      auto bits = rng.next();
+      color.push_back({(uint8_t)bits, (uint8_t)(bits >> 8),
+                       (uint8_t)(bits >> 16), 255});
+    } else {
+      color.push_back(emitter.palette[rng.below(emitter.palette.size())]);
+    }
+  }
+}
+
+void Particles::update(float seconds) {
+  const auto n = count();
+  // nothing here overlaps, which the compiler can't know on it's own.
+  float *__restrict px = x.data();
+  float *__restrict py = y.data();
+  float *__restrict pvx = vx.data();
+  float *__restrict pvy = vy.data();
+  float *__restrict plife = life.data();
+  const float fall = gravity * seconds;
+  for (size_t i = 0; i < n; ++i) {
+    pvy[i] += fall;
+    px[i] += pvx[i] * seconds;
+    py[i] += pvy[i] * seconds;
+    plife[i] -= seconds;
+  }
+
+  // the order doesn't matter, so a finished particle is swapped out for the
+  // last one instead of shuffling everything after it down.
+  size_t alive = n;
+  for (size_t i = 0; i < alive;) {
+    if (life[i] > 0 && y[i] < bottom) {
+      ++i;
+      continue;
+    }
+    --alive;
+    x[i] = x[alive];
+    y[i] = y[alive];
+    vx[i] = vx[alive];
+    vy[i] = vy[alive];
+    size[i] = size[alive];
+    life[i] = life[alive];
+    color[i] = color[alive];
+  }
+  x.resize(alive);
+  y.resize(alive);
+  vx.resize(alive);
+  vy.resize(alive);
+  size.resize(alive);
+  life.resize(alive);
+  color.resize(alive);
+}
+
+void Particles::draw(rayui::DrawList &list, Vector2 origin,
+                     Vector2 scale) const {
+  if (empty()) {
+    return;
+  }
+  auto rects = list.rectangles(count());
+  for (size_t i = 0; i < rects.size(); ++i) {
+    const float width = size[i] * scale.x, height = size[i] * scale.y;
+    auto tint = color[i];
+    if (life[i] < fadeTime) {
+      tint.a = (uint8_t)(tint.a * (life[i] / fadeTime));
+    }
+    rects[i] = {{origin.x + x[i] * scale.x - width / 2,
+                 origin.y + y[i] * scale.y - height / 2, width, height},
+                tint};
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "randomizer.hpp"
+#include "rayui.hpp"
+#include <cmath>
+#include <span>
+#include <vector>
+
+namespace boom_tetris {
+
+// lots of little squares flying about, for the pause screen and celebrating
+// line clears. every field is an array of it's own, so updating them all is a
+// few straight loops over floats the compiler can vectorize, and they're all
+// drawn as one batch.
+//
+// positions are in whatever units the owner likes, board cells for a game or
+// pixels for the pause screen. `draw` scales them onto the screen.
+struct Particles {
+  // where new particles start and how they move, each picked at random
+  // between the two ends.
+  struct Emitter {
+    Rectangle area;
+    Vector2 minVelocity, maxVelocity;
+    float minSize, maxSize;
+    // in seconds.
+    float minLife, maxLife;
+    // the colors to pick from. with none, each particle gets a random one.
+    std::span<const Color> palette = {};
+  };
+
+  std::vector<float> x, y, vx, vy, size, life;
+  std::vector<Color> color;
+
+  // pulls every particle down, in units per second squared.
+  float gravity = 0;
+  // particles that fall past this are gone.
+  float bottom = INFINITY;
+  // particles fade out over the last this many seconds of their life.
+  float fadeTime = 0.5f;
+  // emitting any more than this many at once is ignored.
+  size_t limit = 1 << 16;
+  Rng rng;
+
+  size_t count() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+  void clear();
+  void emit(size_t count, const Emitter &emitter);
+  // moves everything along `seconds`, and drops the particles that are done.
+  void update(float seconds);
+  // records every particle at `origin + position * scale` as one batch.
+  void draw(rayui::DrawList &list, Vector2 origin = {0, 0},
+            Vector2 scale = {1, 1}) const;
+
+private:
+  // a uniform float in [min, max).
+  float uniform(float min, float max) {
+    return min + (max - min) * (float)(rng.next() >> 40) * 0x1p-24f;
+  }
+};
+
+} // namespace boom_tetris
@@ -0,0 +1,148 @@
+#pragma once
+#include "board.hpp"
+#include <algorithm>
+#include <array>
+
+namespace boom_tetris {
+
+// a piece resting somewhere on the board after being dropped straight down.
+struct Placement {
+  Shape shape;
+  Orientation orientation;
+  Vec2 position;
+};
+
+// whether the piece is clear of the walls, the floor and every filled cell.
+// cells above the top of the board are fine, that's where pieces come from.
+template <typename BoardType>
+bool fits(const BoardType &board, Shape shape, Orientation orientation,
+          Vec2 position) {
+  for (const auto &block : shapePatterns[(int)shape]) {
+    auto pos = position + block.pos.rotated(orientation);
+    if (pos.x < 0 || pos.x >= board.width || pos.y >= board.height) {
+      return false;
+    }
+    if (pos.y >= 0 && !board.empty(pos.x, pos.y)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the columns a piece covers and the lowest of it's cells in each, so it can be
+// dropped in one go instead of stepped down a row at a time.
+struct DropProfile {
+  // the leftmost column, relative to the pivot.
+  int left = 4;
+  int width = 0;
+  // the y offset of the lowest cell in each column, relative to the pivot.
+  std::array<int, 4> bottom = {-4, -4, -4, -4};
+};
+
+constexpr auto dropProfiles = [] {
+  std::array<std::array<DropProfile, 4>, shapeCount> profiles = {};
+  for (int s = 0; s < shapeCount; ++s) {
+    for (int o = 0; o < 4; ++o) {
+      auto &profile = profiles[s][o];
+      int right = -4;
+      for (const auto &block : shapePatterns[s]) {
+        auto pos = block.pos.rotated(Orientation(o));
+        profile.left = std::min(profile.left, pos.x);
+        right = std::max(right, pos.x);
+      }
+      profile.width = right - profile.left + 1;
+      for (const auto &block : shapePatterns[s]) {
+        auto pos = block.pos.rotated(Orientation(o));
+        auto &bottom = profile.bottom[pos.x - profile.left];
+        bottom = std::max(bottom, pos.y);
+      }
+    }
+  }
+  return profiles;
+}();
+
+// the row of the topmost filled cell in every column, or the height of the
+// board for empty columns.
+template <typename BoardType>
+std::array<int, BoardType::width> columnTops(const BoardType &board) {
+  std::array<int, BoardType::width> tops;
+  tops.fill(board.height);
+  typename BoardType::Row seen = 0;
+  for (int y = 0; y < board.height && seen != board.fullRow; ++y) {
+    auto fresh = board.rows[y] & ~seen;
+    for (int x = 0; x < board.width; ++x) {
+      if ((fresh >> x) & 1) {
+        tops[x] = y;
+      }
+    }
+    seen |= board.rows[y];
+  }
+  return tops;
+}
+
+// calls `visit(placement)` for every orientation and column `shape` can be
+// dropped straight down into from above the board. no slides or spins under
+// overhangs: if a board can be cleared this way, it can be cleared in game.
+// a piece that lands sticking out of the top is still visited; `place` will
+// refuse it. `visit` returns true to stop early, in which case so does this.
+template <typename BoardType, typename Visit>
+bool forEachDrop(const BoardType &board, Shape shape, Visit &&visit) {
+  auto tops = columnTops(board);
+  for (int o = 0; o < orientationCount(shape); ++o) {
+    const auto &profile = dropProfiles[(int)shape][o];
+    for (int x = -profile.left; x + profile.left + profile.width <= board.width;
+         ++x) {
+      // the piece stops as soon as any of it's columns lands on something.
+      int y = board.height;
+      for (int c = 0; c < profile.width; ++c) {
+        y = std::min(y, tops[x + profile.left + c] - 1 - profile.bottom[c]);
+      }
+      if (visit(Placement{shape, Orientation(o), {x, y}})) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// writes the placed piece into the board. returns false, leaving the board
+// untouched, if any of it would stick out of the top.
+template <typename BoardType>
+bool place(BoardType &board, const Placement &placement) {
+  const auto &pattern = shapePatterns[(int)placement.shape];
+  for (const auto &block : pattern) {
+    if ((placement.position + block.pos.rotated(placement.orientation)).y < 0) {
+      return false;
+    }
+  }
+  for (const auto &block : pattern) {
+    auto pos = placement.position + block.pos.rotated(placement.orientation);
+    board.fill(pos.x, pos.y, block.imageIdx);
+  }
+  return true;
+}
+
+// whether any cell of the placed piece lands in row `y`.
+inline bool touchesRow(const Placement &placement, int y) {
+  for (const auto &block : shapePatterns[(int)placement.shape]) {
+    if ((placement.position + block.pos.rotated(placement.orientation)).y ==
+        y) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// removes every full row, returning how many there were.
+template <typename BoardType> int clearFullRows(BoardType &board) {
+  int cleared = 0;
+  for (int y = 0; y < board.height; ++y) {
+    if (board.full(y)) {
+      board.removeRow(y);
+      cleared++;
+    }
+  }
+  return cleared;
+}
+
+} // namespace boom_tetris
@@ -0,0 +1,119 @@
+#include "profiler.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace boom_tetris;
+
+namespace {
+
+// the innermost phase being timed on this thread.
+thread_local Profiler::Scope *current = nullptr;
+
+const char *phaseNames[Profiler::phases + 1] = {
+    "input", "logic", "animation", "draw", "present", "wait", "frame"};
+
+} // namespace
+
+Profiler::Scope::Scope(Phase phase)
+    : phase(phase), start(Clock::now()), parent(current) {
+  current = this;
+}
+
+Profiler::Scope::~Scope() {
+  auto end = Clock::now();
+  auto elapsed = end - start;
+  tracer().complete(phaseNames[(size_t)phase], start, end);
+  profiler().running[(size_t)phase].fetch_add((elapsed - children).count(),
+                                              std::memory_order_relaxed);
+  if (parent) {
+    parent->children += elapsed;
+  }
+  current = parent;
+}
+
+void Profiler::endFrame(Clock::time_point now) {
+  auto &frame = ring[count % capacity];
+  for (size_t i = 0; i < phases; ++i) {
+    auto ticks = running[i].exchange(0, std::memory_order_relaxed);
+    frame[i] = std::chrono::duration<float, std::milli>(Clock::duration(ticks))
+                   .count();
+  }
+  frame[phases] =
+      std::chrono::duration<float, std::milli>(now - lastFrame).count();
+  lastFrame = now;
+  count++;
+}
+
+void Profiler::draw(rayui::DrawList &list) {
+  if (!visible) {
+    return;
+  }
+  // sorting a few hundred frames a phase is cheap, but not every frame.
+  if (count >= summarized + 30 || count < summarized) {
+    summarized = count;
+    const auto frames = std::min(this->frames(), window);
+    std::vector<float> sorted(frames);
+    for (size_t phase = 0; phase <= phases; ++phase) {
+      for (size_t i = 0; i < frames; ++i) {
+        sorted[i] = ring[(count - 1 - i) % capacity][phase];
+      }
+      std::sort(sorted.begin(), sorted.end());
+      auto at = [&](float p) {
+        return frames ? sorted[std::min(frames - 1, (size_t)(p * frames))] : 0;
+      };
+      snprintf(text[phase].data(), text[phase].size(),
+               "%-9s %6.2f %6.2f %6.2f", phaseNames[phase], at(0.5f),
+               at(0.99f), frames ? sorted.back() : 0);
+    }
+    histogram = {};
+    for (size_t i = 0; i < frames; ++i) {
+      auto ms = ring[(count - 1 - i) % capacity][phases];
+      histogram[std::min(histogram.size() - 1, (size_t)ms)]++;
+    }
+  }
+
+  const float width = 300, x = list.width - width - 4, y = 4;
+  const float lineHeight = 18, chartHeight = 60;
+  const float height = lineHeight * (phases + 2) + chartHeight + 12;
+  list.rectangle(x, y, width, height, GetColor(0x000000cc));
+  list.text("ms        p50    p99    max", x + 6, y + 4, 16, GREEN);
+  for (size_t phase = 0; phase <= phases; ++phase) {
+    list.text(text[phase].data(), x + 6, y + 4 + lineHeight * (phase + 1), 16,
+              GREEN);
+  }
+
+  // a bar a millisecond, the last for anything longer. the ones over a tick
+  // are the frames that show.
+  const float chartY = y + height - 6;
+  const float barWidth = (width - 12) / histogram.size();
+  const auto tallest = std::max<uint16_t>(
+      1, *std::max_element(histogram.begin(), histogram.end()));
+  auto bars = list.rectangles(histogram.size());
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    const float barHeight = chartHeight * histogram[i] / tallest;
+    bars[i] = {{x + 6 + i * barWidth, chartY - barHeight, barWidth - 1,
+                barHeight},
+               i < 16 ? GREEN : RED};
+  }
+}
+
+bool Profiler::writeCsv(const char *path) const {
+  auto file = fopen(path, "w");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "frame");
+  for (auto name : phaseNames) {
+    fprintf(file, ",%s_ms", name);
+  }
+  fprintf(file, "\n");
+  for (size_t i = count - frames(); i < count; ++i) {
+    fprintf(file, "%zu", i);
+    for (auto ms : ring[i % capacity]) {
+      fprintf(file, ",%.3f", ms);
+    }
+    fprintf(file, "\n");
+  }
+  return fclose(file) == 0;
+}
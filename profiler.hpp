@@ -0,0 +1,90 @@
+#pragma once
+#include "rayui.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace boom_tetris {
+
+// where a frame's time goes. each phase only counts it's own time, not the
+// phases timed inside it, so they add up to no more than the frame.
+enum struct Phase : uint8_t {
+  // reading the keyboard and gamepads.
+  Input,
+  // ticking games, less their animations.
+  Logic,
+  // animations holding up a game, like a line clearing.
+  Animation,
+  // recording the screen into the draw list.
+  Draw,
+  // the backend drawing the list, and EndDrawing swapping buffers, waiting
+  // out the frame cap and polling input.
+  Present,
+  // sleeping on purpose, like --late-input waiting for a tick.
+  Wait,
+};
+
+// times the phases of every frame, for finding where the time goes on
+// machines nobody can attach a profiler to. any thread can time a phase, it's
+// added to whichever frame is running on the window's thread. every phase
+// timed also goes in the trace, if there is one.
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t phases = 6;
+  // frames kept, a few minutes' worth.
+  static constexpr size_t capacity = 1 << 14;
+  // the overlay's worked out from this many of the latest frames.
+  static constexpr size_t window = 600;
+
+  // times a phase until it goes out of scope.
+  class Scope {
+  public:
+    explicit Scope(Phase phase);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    Phase phase;
+    Clock::time_point start;
+    Clock::duration children = {};
+    Scope *parent;
+  };
+
+  // milliseconds, for each phase then the whole frame.
+  using Frame = std::array<float, phases + 1>;
+
+  // call once a frame from the window's thread, after presenting.
+  void endFrame(Clock::time_point now = Clock::now());
+  size_t frames() const { return std::min(count, capacity); }
+
+  bool visible = false;
+  // the phases and a histogram of frame times in the top right corner, if
+  // it's `visible`.
+  void draw(rayui::DrawList &list);
+  // every frame kept, oldest first.
+  bool writeCsv(const char *path) const;
+
+private:
+  friend class Scope;
+  // in ticks of `Clock`, for the frame that's running.
+  std::array<std::atomic<int64_t>, phases> running = {};
+  std::vector<Frame> ring = std::vector<Frame>(capacity);
+  size_t count = 0;
+  Clock::time_point lastFrame = Clock::now();
+
+  // the overlay's text, worked out again every so often.
+  size_t summarized = 0;
+  std::array<std::array<char, 64>, phases + 1> text = {};
+  std::array<uint16_t, 34> histogram = {};
+};
+
+// the profiler for the whole game.
+inline Profiler &profiler() {
+  static Profiler profiler;
+  return profiler;
+}
+
+} // namespace boom_tetris
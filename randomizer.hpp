@@ -0,0 +1,119 @@
+#pragma once
+#include "shape.hpp"
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace boom_tetris {
+
+// a tiny seedable prng (splitmix64). it's a handful of instructions per draw,
+// and the whole state is one word, so a randomizer is trivially copyable.
+struct Rng {
+  uint64_t state = 0;
+
+  Rng(uint64_t seed = 0) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  // a uniform value in [0, bound), without a modulo.
+  uint32_t below(uint32_t bound) {
+    return (uint32_t)(((next() >> 32) * bound) >> 32);
+  }
+};
+
+// Randomizer policies. each one decides the next shape given its own history
+// and a source of randomness; `Randomizer<Policy>` below glues them together.
+namespace randomizers {
+
+// every shape is equally likely on every draw, with no memory at all.
+struct Uniform {
+  Shape next(Rng &rng) { return Shape(rng.below(shapeCount)); }
+};
+
+// the original NES algorithm: roll one of 8 values, and if that's the unused
+// 8th value or a repeat of the last piece, roll once more over the 7 shapes and
+// take whatever comes up.
+struct NesReroll {
+  int previous = shapeCount;
+  Shape next(Rng &rng) {
+    int roll = rng.below(shapeCount + 1);
+    if (roll == shapeCount || roll == previous) {
+      roll = rng.below(shapeCount);
+    }
+    previous = roll;
+    return Shape(roll);
+  }
+};
+
+// deal all 7 shapes in a shuffled order, then reshuffle.
+struct SevenBag {
+  std::array<Shape, shapeCount> bag = {};
+  int index = shapeCount;
+  Shape next(Rng &rng) {
+    if (index == shapeCount) {
+      for (int i = 0; i < shapeCount; ++i) {
+        bag[i] = Shape(i);
+      }
+      for (int i = shapeCount - 1; i > 0; --i) {
+        auto j = rng.below(i + 1);
+        std::swap(bag[i], bag[j]);
+      }
+      index = 0;
+    }
+    return bag[index++];
+  }
+};
+
+// the TGM algorithm: remember the last 4 pieces and roll up to `Rolls` times
+// for one that isn't in that history. the first piece is never S, Z or O.
+template <int Rolls = 4> struct TgmHistory {
+  std::array<Shape, 4> history = {Shape::Z, Shape::Z, Shape::Z, Shape::Z};
+  bool first = true;
+  Shape next(Rng &rng) {
+    Shape shape;
+    if (first) {
+      constexpr Shape openers[] = {Shape::I, Shape::J, Shape::L, Shape::T};
+      shape = openers[rng.below(4)];
+      first = false;
+    } else {
+      unsigned recent = 0;
+      for (auto seen : history) {
+        recent |= 1u << (int)seen;
+      }
+      for (int roll = 0; roll < Rolls; ++roll) {
+        shape = Shape(rng.below(shapeCount));
+        if (!(recent & (1u << (int)shape))) {
+          break;
+        }
+      }
+    }
+    history = {shape, history[0], history[1], history[2]};
+    return shape;
+  }
+};
+
+} // namespace randomizers
+
+// a piece generator: a policy plus the rng it draws from.
+template <typename Policy> struct Randomizer {
+  Rng rng;
+  Policy policy;
+
+  Randomizer(uint64_t seed = 0) : rng(seed) {}
+
+  Shape next() { return policy.next(rng); }
+};
+
+// the policy the game is built with. pick another one with
+// -DBOOM_TETRIS_RANDOMIZER=NesReroll (see CMakeLists.txt).
+#ifndef BOOM_TETRIS_RANDOMIZER
+#define BOOM_TETRIS_RANDOMIZER Uniform
+#endif
+using GameRandomizer = Randomizer<randomizers::BOOM_TETRIS_RANDOMIZER>;
+
+} // namespace boom_tetris
@@ -0,0 +1,268 @@
+// draws a lot of pieces from every randomizer policy and reports how fast they
+// are and how the sequences they produce are distributed.
+//
+// usage: boom_tetris_randomizer_bench [pieces per policy] [threads] [seed]
+
+#include "randomizer.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace boom_tetris;
+
+// droughts at least this long all land in the last bucket.
+constexpr int maxDrought = 255;
+
+using DroughtHistogram = std::array<uint64_t, maxDrought + 1>;
+
+struct Stats {
+  uint64_t pieces = 0;
+  // pairs[a][b] counts `a` being dealt immediately before `b`.
+  std::array<std::array<uint64_t, shapeCount>, shapeCount> pairs = {};
+  // how many pieces went by between two of the same shape, over all shapes.
+  DroughtHistogram droughts = {};
+  // the same, only for the long bar.
+  DroughtHistogram longbarDroughts = {};
+  uint64_t longestDrought = 0;
+  uint64_t longestLongbarDrought = 0;
+
+  void merge(const Stats &other) {
+    pieces += other.pieces;
+    for (int a = 0; a < shapeCount; ++a) {
+      for (int b = 0; b < shapeCount; ++b) {
+        pairs[a][b] += other.pairs[a][b];
+      }
+    }
+    for (int i = 0; i <= maxDrought; ++i) {
+      droughts[i] += other.droughts[i];
+      longbarDroughts[i] += other.longbarDroughts[i];
+    }
+    longestDrought = std::max(longestDrought, other.longestDrought);
+    longestLongbarDrought =
+        std::max(longestLongbarDrought, other.longestLongbarDrought);
+  }
+};
+
+template <typename Policy> Stats drawPieces(uint64_t seed, uint64_t count) {
+  Randomizer<Policy> randomizer(seed);
+  Stats stats;
+  stats.pieces = count;
+
+  // the index each shape was last dealt at, 0 meaning never.
+  std::array<uint64_t, shapeCount> lastSeen = {};
+  int previous = -1;
+
+  for (uint64_t i = 1; i <= count; ++i) {
+    auto shape = (int)randomizer.next();
+    if (previous >= 0) {
+      stats.pairs[previous][shape]++;
+    }
+    previous = shape;
+
+    if (lastSeen[shape] != 0) {
+      auto drought = i - lastSeen[shape] - 1;
+      stats.longestDrought = std::max(stats.longestDrought, drought);
+      stats.droughts[std::min<uint64_t>(drought, maxDrought)]++;
+      if (shape == (int)Shape::I) {
+        stats.longestLongbarDrought =
+            std::max(stats.longestLongbarDrought, drought);
+        stats.longbarDroughts[std::min<uint64_t>(drought, maxDrought)]++;
+      }
+    }
+    lastSeen[shape] = i;
+  }
+  return stats;
+}
+
+// the smallest drought length that covers `fraction` of all droughts.
+static uint64_t percentile(const DroughtHistogram &histogram, double fraction) {
+  uint64_t total = 0;
+  for (auto n : histogram) {
+    total += n;
+  }
+  uint64_t target = total * fraction, seen = 0;
+  for (int i = 0; i <= maxDrought; ++i) {
+    seen += histogram[i];
+    if (seen > target) {
+      return i;
+    }
+  }
+  return maxDrought;
+}
+
+static double mean(const DroughtHistogram &histogram) {
+  double sum = 0, total = 0;
+  for (int i = 0; i <= maxDrought; ++i) {
+    sum += double(i) * histogram[i];
+    total += histogram[i];
+  }
+  return total > 0 ? sum / total : 0;
+}
+
+static void printDroughts(const char *title, const DroughtHistogram &histogram,
+                          uint64_t longest) {
+  printf("  %-22s mean %5.2f  p50 %3llu  p99 %3llu  p99.9 %3llu  max %llu\n",
+         title, mean(histogram),
+         (unsigned long long)percentile(histogram, 0.5),
+         (unsigned long long)percentile(histogram, 0.99),
+         (unsigned long long)percentile(histogram, 0.999),
+         (unsigned long long)longest);
+}
+
+static void printLongbarHistogram(const DroughtHistogram &histogram) {
+  uint64_t total = 0;
+  for (auto n : histogram) {
+    total += n;
+  }
+  if (total == 0) {
+    return;
+  }
+  printf("  long bar droughts:\n");
+  constexpr int bucket = 5, lastBucket = 60;
+  for (int start = 0; start <= lastBucket; start += bucket) {
+    uint64_t n = 0;
+    int end = start == lastBucket ? maxDrought : start + bucket - 1;
+    for (int i = start; i <= end; ++i) {
+      n += histogram[i];
+    }
+    auto percent = 100.0 * n / total;
+    auto label = start == lastBucket
+                     ? std::to_string(start) + "+"
+                     : std::to_string(start) + "-" + std::to_string(end);
+    printf("    %7s %9.5f%% %s\n", label.c_str(), percent,
+           std::string(std::min<int>(percent, 60), '#').c_str());
+  }
+}
+
+static void printPairs(const Stats &stats) {
+  constexpr const char *names = "LJZSITO";
+  uint64_t total = 0;
+  for (auto &row : stats.pairs) {
+    for (auto n : row) {
+      total += n;
+    }
+  }
+  if (total == 0) {
+    return;
+  }
+  // 1.00 would be what a memoryless randomizer produces.
+  printf("  pair frequency relative to uniform (row: first, column: next):\n");
+  printf("       ");
+  for (int b = 0; b < shapeCount; ++b) {
+    printf("    %c", names[b]);
+  }
+  printf("\n");
+  for (int a = 0; a < shapeCount; ++a) {
+    printf("    %c  ", names[a]);
+    for (int b = 0; b < shapeCount; ++b) {
+      double expected = double(total) / (shapeCount * shapeCount);
+      printf(" %4.2f", stats.pairs[a][b] / expected);
+    }
+    printf("\n");
+  }
+}
+
+// just deal pieces as fast as possible, so the stats bookkeeping above doesn't
+// hide what the randomizer itself costs.
+template <typename Policy> uint64_t drawOnly(uint64_t seed, uint64_t count) {
+  Randomizer<Policy> randomizer(seed);
+  uint64_t checksum = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    checksum = checksum * 31 + (uint64_t)randomizer.next();
+  }
+  return checksum;
+}
+
+// splits `pieces` over `threadCount` threads, calls `work(thread, seed,
+// count)` on each, and returns the wall clock time it took in seconds.
+template <typename Work>
+double parallel(uint64_t pieces, unsigned threadCount, uint64_t seed,
+                Work work) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threadCount; ++t) {
+    auto count = pieces / threadCount + (t < pieces % threadCount ? 1 : 0);
+    // derive an unrelated stream for every thread from the one seed.
+    auto threadSeed = Rng(seed + t).next();
+    threads.emplace_back(
+        [&work, t, count, threadSeed] { work(t, threadSeed, count); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+template <typename Policy>
+void run(const char *name, uint64_t pieces, unsigned threadCount,
+         uint64_t seed) {
+  std::vector<uint64_t> checksums(threadCount);
+  auto drawSeconds =
+      parallel(pieces, threadCount, seed,
+               [&](unsigned t, uint64_t threadSeed, uint64_t count) {
+                 checksums[t] = drawOnly<Policy>(threadSeed, count);
+               });
+
+  std::vector<Stats> results(threadCount);
+  auto statsSeconds =
+      parallel(pieces, threadCount, seed,
+               [&](unsigned t, uint64_t threadSeed, uint64_t count) {
+                 results[t] = drawPieces<Policy>(threadSeed, count);
+               });
+
+  Stats stats;
+  for (const auto &result : results) {
+    stats.merge(result);
+  }
+  uint64_t checksum = 0;
+  for (auto n : checksums) {
+    checksum ^= n;
+  }
+
+  printf("%s: %llu pieces on %u threads (checksum %016llx)\n", name,
+         (unsigned long long)stats.pieces, threadCount,
+         (unsigned long long)checksum);
+  printf("  draw only:  %8.3f s  %8.1f M pieces/s  %6.2f ns/piece/thread\n",
+         drawSeconds, pieces / drawSeconds / 1e6,
+         drawSeconds * threadCount * 1e9 / std::max<uint64_t>(pieces, 1));
+  printf("  with stats: %8.3f s  %8.1f M pieces/s  %6.2f ns/piece/thread\n",
+         statsSeconds, pieces / statsSeconds / 1e6,
+         statsSeconds * threadCount * 1e9 / std::max<uint64_t>(pieces, 1));
+  printDroughts("droughts (any shape):", stats.droughts, stats.longestDrought);
+  printDroughts("droughts (long bar):", stats.longbarDroughts,
+                stats.longestLongbarDrought);
+  printLongbarHistogram(stats.longbarDroughts);
+  printPairs(stats);
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t pieces = 1'000'000'000;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  uint64_t seed = 1989;
+
+  if (argc > 1) {
+    pieces = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    threads = std::max(1, std::atoi(argv[2]));
+  }
+  if (argc > 3) {
+    seed = std::strtoull(argv[3], nullptr, 10);
+  }
+
+  run<randomizers::Uniform>("uniform", pieces, threads, seed);
+  run<randomizers::NesReroll>("nes", pieces, threads, seed);
+  run<randomizers::SevenBag>("7-bag", pieces, threads, seed);
+  run<randomizers::TgmHistory<4>>("tgm (4 rolls)", pieces, threads, seed);
+  run<randomizers::TgmHistory<6>>("tgm (6 rolls)", pieces, threads, seed);
+  return 0;
+}
@@ -1,9 +1,19 @@
 #pragma once
+#include <cassert>
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <new>
 #include <raylib.h>
+#include <rlgl.h>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace rayui {
@@ -82,6 +92,10 @@ struct Margin {
 struct LayoutState {
   PixelPosition position;
   PixelSize size;
+  bool operator==(const LayoutState &other) const {
+    return position.x == other.position.x && position.y == other.position.y &&
+           size.width == other.size.width && size.height == other.size.height;
+  }
   void applyMargin(Margin margin) {
     size.width -= margin.left + margin.right;
     size.height -= margin.top + margin.bottom;
@@ -157,6 +171,193 @@ struct LayoutState {
   }
 };
 
+// one thing to draw. rayui doesn't draw straight to the screen, it records a
+// frame as a list of these that a backend puts on screen afterwards.
+struct DrawCommand {
+  enum struct Kind : uint32_t {
+    Clear,
+    Rect,
+    RectLines,
+    Circle,
+    Texture,
+    Text,
+    // plain rectangles from `DrawList::batchRects`, in [index, end).
+    Rects,
+    // the commands between these two are drawn into `texture`.
+    BeginLayer,
+    EndLayer,
+  } kind;
+  Color color;
+  // where it's drawn. circles keep their center and radius in x, y & width.
+  Rectangle dest;
+  // the part of the texture that's drawn.
+  Rectangle source;
+  Vector2 origin;
+  // the rotation of a texture, the thickness of lines or the size of text.
+  float value;
+  Texture2D texture;
+  // where the text starts in `DrawList::strings`, or for layers, the render
+  // texture in `DrawList::targets`.
+  uint32_t index;
+  // for the start of a layer, the index of the command that ends it. for a
+  // batch of rectangles, where it stops.
+  uint32_t end;
+};
+static_assert(sizeof(DrawCommand) == 80, "draw commands are compared as bytes");
+
+// a frame's worth of draw commands, and how much drawing it is.
+struct DrawList {
+  std::vector<DrawCommand> commands;
+  // the text of every text command, each ending in a 0.
+  std::vector<char> strings;
+  std::vector<RenderTexture2D> targets;
+  // a rectangle in a batch. see `rectangles`.
+  struct BatchRect {
+    Rectangle rect;
+    Color color;
+  };
+  std::vector<BatchRect> batchRects;
+  // the size of the frame being drawn, in pixels.
+  int width = 0, height = 0;
+
+  // how much work the frame is for a backend like raylib's, to keep an eye
+  // on without a gpu profiler.
+  struct Counters {
+    int drawCalls = 0;
+    // times it changes from drawing one texture to another, which is what
+    // ends a batch. shapes and text each count as a texture of their own.
+    int textureSwitches = 0;
+    int textDraws = 0;
+  } counters;
+
+  // empties the list for the next frame, keeping it's storage.
+  void reset(int width, int height) {
+    this->width = width;
+    this->height = height;
+    commands.clear();
+    strings.clear();
+    targets.clear();
+    batchRects.clear();
+    counters = {};
+    boundTexture = noTexture;
+    layers.clear();
+  }
+
+  void clearBackground(Color color) {
+    push({.kind = DrawCommand::Kind::Clear, .color = color});
+  }
+  void rectangle(int x, int y, int width, int height, Color color) {
+    rectangle({(float)x, (float)y, (float)width, (float)height}, color);
+  }
+  void rectangle(Rectangle rect, Color color) {
+    bind(shapes);
+    push({.kind = DrawCommand::Kind::Rect, .color = color, .dest = rect});
+  }
+  void rectangleLines(Rectangle rect, float thickness, Color color) {
+    bind(shapes);
+    push({.kind = DrawCommand::Kind::RectLines,
+          .color = color,
+          .dest = rect,
+          .value = thickness});
+  }
+  void circle(int x, int y, float radius, Color color) {
+    bind(shapes);
+    push({.kind = DrawCommand::Kind::Circle,
+          .color = color,
+          .dest = {(float)x, (float)y, radius, 0}});
+  }
+  // room for `count` rectangles drawn as one command, for things like particles
+  // that are too many for a command each. every one of them is to be filled
+  // in.
+  std::span<BatchRect> rectangles(size_t count) {
+    bind(shapes);
+    auto start = (uint32_t)batchRects.size();
+    batchRects.resize(start + count);
+    push({.kind = DrawCommand::Kind::Rects,
+          .index = start,
+          .end = start + (uint32_t)count});
+    return std::span(batchRects).subspan(start, count);
+  }
+  void texture(Texture2D texture, Rectangle source, Rectangle dest,
+               Color tint = WHITE, Vector2 origin = {0, 0},
+               float rotation = 0) {
+    bind(texture.id);
+    push({.kind = DrawCommand::Kind::Texture,
+          .color = tint,
+          .dest = dest,
+          .source = source,
+          .origin = origin,
+          .value = rotation,
+          .texture = texture});
+  }
+  void text(const char *text, int x, int y, int fontSize, Color color) {
+    bind(font);
+    counters.textDraws++;
+    push({.kind = DrawCommand::Kind::Text,
+          .color = color,
+          .dest = {(float)x, (float)y, 0, 0},
+          .value = (float)fontSize,
+          .index = (uint32_t)strings.size()});
+    strings.insert(strings.end(), text, text + std::strlen(text) + 1);
+  }
+
+  // everything recorded until the matching `endLayer` is drawn into `target`
+  // instead of the frame. layers can be inside one another.
+  void beginLayer(RenderTexture2D target) {
+    layers.push_back({(uint32_t)commands.size(), boundTexture});
+    boundTexture = noTexture;
+    commands.push_back({.kind = DrawCommand::Kind::BeginLayer,
+                        .index = (uint32_t)targets.size()});
+    targets.push_back(target);
+  }
+  void endLayer() {
+    auto [begin, bound] = layers.back();
+    layers.pop_back();
+    commands[begin].end = commands.size();
+    commands.push_back({.kind = DrawCommand::Kind::EndLayer, .index = begin});
+    boundTexture = bound;
+  }
+
+  // whether drawing this would come out the same as drawing `other`.
+  bool operator==(const DrawList &other) const {
+    // the commands are plain bytes with no padding, so compare them as that.
+    auto same = [](const auto &a, const auto &b) {
+      return a.size() == b.size() &&
+             (a.empty() ||
+              std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+    };
+    return width == other.width && height == other.height &&
+           same(commands, other.commands) && same(strings, other.strings) &&
+           same(targets, other.targets) && same(batchRects, other.batchRects);
+  }
+
+private:
+  // stand ins for the textures raylib draws shapes and text with.
+  static constexpr unsigned noTexture = ~0u, shapes = ~0u - 1, font = ~0u - 2;
+  unsigned boundTexture = noTexture;
+  // the layers that have begun and not ended yet, and what was bound outside
+  // them.
+  std::vector<std::pair<uint32_t, unsigned>> layers;
+
+  void bind(unsigned texture) {
+    if (texture != boundTexture) {
+      counters.textureSwitches++;
+      boundTexture = texture;
+    }
+  }
+  void push(DrawCommand command) {
+    counters.drawCalls++;
+    commands.push_back(command);
+  }
+};
+
+// the list rayui's elements record into. whoever runs the frame resets it to
+// the frame's size before drawing and hands it to a backend after.
+inline DrawList &drawList() {
+  static DrawList list;
+  return list;
+}
+
 // the base class for all UI elements.
 struct Element {
   Element(Position position, Size size,
@@ -172,70 +373,276 @@ struct Element {
   Size size = {1, 1};
   Margin margin = {0, 0, 0, 0};
   virtual void draw(LayoutState &state) = 0;
+
+  // set this after changing something an element can't notice by itself, like
+  // it's style or position, so a `Layer` it's in gets redrawn.
+  bool dirty = true;
+  // a hidden element keeps it's place in the grid, but isn't drawn. for parts
+  // of a screen that come and go, without making the screen again.
+  bool hidden = false;
+  void setHidden(bool hidden) {
+    if (hidden != this->hidden) {
+      this->hidden = hidden;
+      dirty = true;
+    }
+  }
+  // whether it would look any different if it were drawn again now.
+  virtual bool changed() const { return dirty; }
+  // called by the `Layer` it's in once it's been drawn.
+  virtual void markClean() { dirty = false; }
+
+  // the grid an element is in works out where it goes once and keeps it. call
+  // this after changing it's position, size, margin or layout kind.
+  bool layoutDirty = true;
+  virtual void invalidateLayout() {
+    layoutDirty = true;
+    dirty = true;
+  }
+};
+
+// where the elements of a screen live. they're made one after another in a few
+// big blocks, so drawing walks memory in order, and the whole screen goes away
+// in one `reset` instead of one free per element.
+class Arena {
+public:
+  Arena(size_t blockSize = 16 * 1024) : blockSize(blockSize) {}
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  ~Arena() { reset(); }
+
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    auto object = new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors.push_back(
+          {object, [](void *object) { static_cast<T *>(object)->~T(); }});
+    }
+    return object;
+  }
+
+  // destroys everything made since the last reset, newest first. the blocks
+  // are kept for the next screen.
+  void reset() {
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+      it->destroy(it->object);
+    }
+    destructors.clear();
+    current = 0;
+    used = 0;
+  }
+
+private:
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+  struct Destructor {
+    void *object;
+    void (*destroy)(void *);
+  };
+
+  void *allocate(size_t size, size_t alignment) {
+    for (; current < blocks.size(); ++current, used = 0) {
+      auto offset = (used + alignment - 1) & ~(alignment - 1);
+      if (offset + size <= blocks[current].size) {
+        used = offset + size;
+        return blocks[current].data.get() + offset;
+      }
+    }
+    auto blockSize = std::max(size, this->blockSize);
+    blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+    used = size;
+    return blocks[current].data.get();
+  }
+
+  size_t blockSize;
+  std::vector<Block> blocks;
+  // the block being filled, and how much of it is.
+  size_t current = 0, used = 0;
+  std::vector<Destructor> destructors;
 };
 
 // a container for a group of elements: a grid.
 struct Grid : Element {
-  template <typename T, typename... Args>
-  std::shared_ptr<T> emplace_element(Args &&...args) {
-    auto element = std::make_shared<T>(args...);
+  // makes an element in the grid's arena, which owns it. grids made this way
+  // put their own elements in the same arena.
+  template <typename T, typename... Args> T *emplace_element(Args &&...args) {
+    assert(arena && "a grid needs an arena to put elements in");
+    auto element = arena->create<T>(std::forward<Args>(args)...);
+    if constexpr (std::is_base_of_v<Grid, T>) {
+      element->arena = arena;
+    }
     elements.push_back(element);
     return element;
   }
   Grid(Position pos, Size size) : Element(pos, size) {}
   Grid(Size subdivisions = {1, 1}) : Element(), subdivisions(subdivisions) {}
+  Grid(Arena &arena, Size subdivisions = {1, 1})
+      : Element(), arena(&arena), subdivisions(subdivisions) {}
+
+  // where the elements are kept. copies of a grid share it.
+  Arena *arena = nullptr;
+  std::vector<Element *> elements;
+
+  bool changed() const override {
+    if (dirty) {
+      return true;
+    }
+    for (const auto &element : elements) {
+      // what a hidden element shows doesn't matter, only it being hidden.
+      if (element->hidden ? element->dirty : element->changed()) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void markClean() override {
+    dirty = false;
+    for (const auto &element : elements) {
+      element->markClean();
+    }
+  }
+
+  // where each element goes, worked out for the state the grid was last laid
+  // out in and kept until that or an element changes.
+  std::vector<LayoutState> layout;
+  LayoutState laidOutIn = {};
 
-  std::vector<std::shared_ptr<Element>> elements;
+  // lays everything out again, down through any grids inside this one too.
+  // call it after changing `subdivisions`.
+  void invalidateLayout() override {
+    Element::invalidateLayout();
+    layout.clear();
+    for (const auto &element : elements) {
+      element->invalidateLayout();
+    }
+  }
 
   void draw(LayoutState &state) override {
+    drawList().rectangle(state.position.x, state.position.y, state.size.width,
+                         state.size.height, style.background);
+
+    if (layout.size() != elements.size() || !(state == laidOutIn)) {
+      layout.resize(elements.size());
+      laidOutIn = state;
+      for (size_t i = 0; i < elements.size(); ++i) {
+        layout[i] = place(*elements[i], state);
+        elements[i]->layoutDirty = false;
+      }
+    }
+
+    for (size_t i = 0; i < elements.size(); ++i) {
+      auto &element = elements[i];
+      if (element->hidden) {
+        continue;
+      }
+      if (element->layoutDirty) {
+        layout[i] = place(*element, state);
+        element->layoutDirty = false;
+      }
+      // elements are free to scribble on their state.
+      auto elementState = layout[i];
+      element->draw(elementState);
+    }
+  }
+
+  // where `element` goes when the grid is drawn in `state`.
+  LayoutState place(const Element &element, const LayoutState &state) const {
     // Calculate the size of each cell in the grid
     float cellWidth = state.size.width / subdivisions.width;
     float cellHeight = state.size.height / subdivisions.height;
-    DrawRectangle(state.position.x, state.position.y, state.size.width,
-                  state.size.height, style.background);
 
-    for (const auto &element : elements) {
-      LayoutState elementState;
-      // keep element in bounds of grid
-      auto maxElementX = subdivisions.width - std::max(element->size.width, 1);
-      auto maxElementY =
-          subdivisions.height - std::max(element->size.height, 1);
-      auto elementX = std::min(std::max(element->position.x, 0), maxElementX);
-      auto elementY = std::min(std::max(element->position.y, 0), maxElementY);
-      // Convert grid position and size to pixel values
-      float pixelPosX = state.position.x + elementX * cellWidth;
-      float pixelPosY = state.position.y + elementY * cellHeight;
-      float pixelSizeX = element->size.width * cellWidth;
-      float pixelSizeY = element->size.height * cellHeight;
-
-      switch (element->layoutKind) {
-      case LayoutKind::None:
-        elementState.position = {pixelPosX, pixelPosY};
-        elementState.size = {pixelSizeX, pixelSizeY};
-        break;
-      case LayoutKind::StretchHorizontal:
-        elementState.position.x = state.position.x;
-        elementState.position.y = pixelPosY;
-        elementState.size.width = state.size.width; // Stretch horizontally
-        elementState.size.height =
-            pixelSizeY; // Use the calculated pixel height
-        break;
-      case LayoutKind::StretchVertical:
-        elementState.position.x = pixelPosX;
-        elementState.position.y = state.position.y;
-        elementState.size.width = pixelSizeX; // Use the calculated pixel width
-        elementState.size.height = state.size.height; // Stretch vertically
-        break;
-      }
+    LayoutState elementState;
+    // keep element in bounds of grid
+    auto maxElementX = subdivisions.width - std::max(element.size.width, 1);
+    auto maxElementY = subdivisions.height - std::max(element.size.height, 1);
+    auto elementX = std::min(std::max(element.position.x, 0), maxElementX);
+    auto elementY = std::min(std::max(element.position.y, 0), maxElementY);
+    // Convert grid position and size to pixel values
+    float pixelPosX = state.position.x + elementX * cellWidth;
+    float pixelPosY = state.position.y + elementY * cellHeight;
+    float pixelSizeX = element.size.width * cellWidth;
+    float pixelSizeY = element.size.height * cellHeight;
 
-      elementState.applyMargin(element->margin);
-      element->draw(elementState);
+    switch (element.layoutKind) {
+    case LayoutKind::None:
+      elementState.position = {pixelPosX, pixelPosY};
+      elementState.size = {pixelSizeX, pixelSizeY};
+      break;
+    case LayoutKind::StretchHorizontal:
+      elementState.position.x = state.position.x;
+      elementState.position.y = pixelPosY;
+      elementState.size.width = state.size.width; // Stretch horizontally
+      elementState.size.height = pixelSizeY; // Use the calculated pixel height
+      break;
+    case LayoutKind::StretchVertical:
+      elementState.position.x = pixelPosX;
+      elementState.position.y = state.position.y;
+      elementState.size.width = pixelSizeX; // Use the calculated pixel width
+      elementState.size.height = state.size.height; // Stretch vertically
+      break;
     }
+
+    elementState.applyMargin(element.margin);
+    return elementState;
   }
 
   Size subdivisions = {1, 1};
 };
 
+// a grid that draws into a texture, and after that only puts the texture on
+// screen until it's resized or one of it's elements changes. it's for the
+// parts of a screen that hardly ever change, like labels and backgrounds.
+// - Button and Slider don't belong in one, they have to draw every frame to
+//   see the mouse.
+// - give it an opaque background, text edges blended onto a clear texture come
+//   out darker.
+// - layers don't nest.
+struct Layer : Grid {
+  using Grid::Grid;
+  Layer(const Layer &) = delete;
+  Layer &operator=(const Layer &) = delete;
+  ~Layer() {
+    if (texture.id != 0) {
+      UnloadRenderTexture(texture);
+    }
+  }
+
+  RenderTexture2D texture = {};
+
+  void draw(LayoutState &state) override {
+    // render textures need a gpu, without a window it just draws through.
+    if (!IsWindowReady()) {
+      Grid::draw(state);
+      return;
+    }
+    int width = std::ceil(state.size.width);
+    int height = std::ceil(state.size.height);
+    if (texture.id == 0 || texture.texture.width != width ||
+        texture.texture.height != height) {
+      if (texture.id != 0) {
+        UnloadRenderTexture(texture);
+      }
+      texture = LoadRenderTexture(width, height);
+      dirty = true;
+    }
+    if (changed()) {
+      drawList().beginLayer(texture);
+      drawList().clearBackground(BLANK);
+      LayoutState local = {{0, 0}, state.size};
+      Grid::draw(local);
+      drawList().endLayer();
+      markClean();
+    }
+    // render textures come out upside down.
+    drawList().texture(texture.texture, {0, 0, (float)width, -(float)height},
+                       {std::floor(state.position.x),
+                        std::floor(state.position.y), (float)width,
+                        (float)height});
+  }
+};
+
 // A basic colored rectangle.
 struct Rect : Element {
   Rect(Position position, Size size, Style style = {},
@@ -243,8 +650,8 @@ struct Rect : Element {
       : Element(position, size, layoutKind, style, margin) {}
 
   void draw(LayoutState &state) override {
-    DrawRectangle(state.position.x, state.position.y, state.size.width,
-                  state.size.height, style.background);
+    drawList().rectangle(state.position.x, state.position.y, state.size.width,
+                         state.size.height, style.background);
   }
 };
 
@@ -258,12 +665,20 @@ struct Label : Element {
     style.foreground = foreground;
   }
   Label(Position pos, Size size) : Element(pos, size) {}
+
+  // the text as it was last drawn.
+  std::string shown;
+  bool changed() const override { return dirty || text != shown; }
+
   void draw(LayoutState &state) override {
-    DrawRectangle(state.position.x, state.position.y, state.size.width,
-                  state.size.height, style.background);
+    if (shown != text) {
+      shown = text;
+    }
+    drawList().rectangle(state.position.x, state.position.y, state.size.width,
+                         state.size.height, style.background);
     auto fontSize = state.size.height;
-    DrawText(text.c_str(), state.position.x, state.position.y, fontSize,
-             style.foreground);
+    drawList().text(text.c_str(), state.position.x, state.position.y,
+                    fontSize, style.foreground);
   }
 };
 
@@ -282,6 +697,13 @@ struct Button : Element {
       : Element(position, size, layoutKind, style), text(text),
         onClicked(onClicked) {}
 
+  // it has to see the mouse every frame.
+  bool changed() const override { return true; }
+
+  std::string measuredText;
+  size_t measuredFontSize = 0;
+  int textWidth = 0;
+
   void draw(LayoutState &state) override {
     bool isMouseOver = CheckCollisionPointRec(
         GetMousePosition(), {state.position.x, state.position.y,
@@ -291,28 +713,137 @@ struct Button : Element {
         onClicked();
       }
     }
-    DrawRectangle(state.position.x, state.position.y, state.size.width,
-                  state.size.height, style.background);
+    drawList().rectangle(state.position.x, state.position.y, state.size.width,
+                         state.size.height, style.background);
 
     if (isMouseOver) {
-      DrawRectangleLinesEx({state.position.x, state.position.y,
-                            state.size.width, state.size.height},
-                           style.borderSize, style.foreground);
+      drawList().rectangleLines({state.position.x, state.position.y,
+                                 state.size.width, state.size.height},
+                                style.borderSize, style.foreground);
     } else {
-      DrawRectangleLinesEx({state.position.x, state.position.y,
-                            state.size.width, state.size.height},
-                           style.borderSize, style.borderColor);
+      drawList().rectangleLines({state.position.x, state.position.y,
+                                 state.size.width, state.size.height},
+                                style.borderSize, style.borderColor);
+    }
+    // only measure the text again when it or the font size changed.
+    if (text != measuredText || fontSize != measuredFontSize) {
+      measuredText = text;
+      measuredFontSize = fontSize;
+      textWidth = MeasureText(text.c_str(), fontSize);
     }
-    int textWidth = MeasureText(text.c_str(), fontSize);
 
     auto pos_x =
         state.position.x + (0.5 * state.size.width) - (textWidth / 2.0f);
     auto pos_y =
         state.position.y + (0.5 * state.size.height) - (fontSize / 2.0f);
 
-    DrawText(text.c_str(), pos_x, pos_y, fontSize, style.foreground);
+    drawList().text(text.c_str(), pos_x, pos_y, fontSize, style.foreground);
+  }
+};
+// many images packed into one texture at startup, so whatever's drawn from
+// them is one batch instead of a texture switch each. `add` every image, then
+// `build` once, and draw with `texture` and a sprite's `source`.
+class Atlas {
+public:
+  Atlas() = default;
+  Atlas(const Atlas &) = delete;
+  Atlas &operator=(const Atlas &) = delete;
+  ~Atlas() {
+    for (auto &sprite : sprites) {
+      UnloadImage(sprite.image);
+    }
+    if (uploaded) {
+      UnloadTexture(texture);
+    }
+    UnloadImage(image);
+  }
+
+  // the packed texture, and it's pixels. without a window there's no gpu
+  // texture, and `texture` just stands in for `image` for a software backend.
+  Texture2D texture = {};
+  ::Image image = {};
+
+  // takes `image` to be packed, and returns the sprite it becomes.
+  size_t add(::Image image) {
+    sprites.push_back({image, {}});
+    return sprites.size() - 1;
+  }
+  size_t load(const char *path) { return add(LoadImage(path)); }
+
+  // where sprite `index` ended up in the texture.
+  Rectangle source(size_t index) const { return sprites[index].source; }
+
+  // packs the sprites in rows, tallest first, with a pixel of space between
+  // them so filtering can't bleed one into the next.
+  void build() {
+    assert(!built && "an atlas is only built once");
+    built = true;
+    constexpr int padding = 1;
+    std::vector<size_t> order(sprites.size());
+    int area = 0, widest = 0;
+    for (size_t i = 0; i < sprites.size(); ++i) {
+      order[i] = i;
+      const auto &image = sprites[i].image;
+      area += (image.width + padding) * (image.height + padding);
+      widest = std::max(widest, image.width + padding);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return sprites[a].image.height > sprites[b].image.height;
+    });
+    // about square, and a power of two wide.
+    int width = 1;
+    while (width < std::max(widest, (int)std::sqrt((float)area))) {
+      width *= 2;
+    }
+
+    int x = 0, y = 0, rowHeight = 0;
+    for (auto i : order) {
+      const auto &image = sprites[i].image;
+      if (x + image.width > width) {
+        x = 0;
+        y += rowHeight;
+        rowHeight = 0;
+      }
+      sprites[i].source = {(float)x, (float)y, (float)image.width,
+                           (float)image.height};
+      x += image.width + padding;
+      rowHeight = std::max(rowHeight, image.height + padding);
+    }
+
+    image = GenImageColor(width, std::max(1, y + rowHeight), BLANK);
+    auto pixels = (Color *)image.data;
+    for (auto &sprite : sprites) {
+      auto colors = LoadImageColors(sprite.image);
+      const int left = sprite.source.x, top = sprite.source.y;
+      for (int row = 0; row < sprite.image.height; ++row) {
+        std::memcpy(pixels + (top + row) * width + left,
+                    colors + row * sprite.image.width,
+                    sprite.image.width * sizeof(Color));
+      }
+      UnloadImageColors(colors);
+      UnloadImage(sprite.image);
+      sprite.image = {};
+    }
+
+    uploaded = IsWindowReady();
+    if (uploaded) {
+      texture = LoadTextureFromImage(image);
+    } else {
+      static unsigned standIns = 1;
+      texture = {standIns++, image.width, image.height, 1, image.format};
+    }
   }
+
+private:
+  struct Sprite {
+    // it's pixels until the atlas is built.
+    ::Image image;
+    Rectangle source;
+  };
+  std::vector<Sprite> sprites;
+  bool built = false, uploaded = false;
 };
+
 // An easy way to draw a texture within a UI.
 struct Image : Element {
   FillType fillType = FillType::Stretch;
@@ -348,13 +879,20 @@ struct Image : Element {
     imageSourceRect = {0, 0, (float)texture.width, (float)texture.height};
   }
 
+  // just the `source` part of `texture`, like a sprite in an `Atlas`.
+  Image(Position position, Size size, Texture2D texture, Rectangle source,
+        Style style = {BLACK, WHITE, WHITE, 0},
+        LayoutKind layoutKind = LayoutKind::None)
+      : Element(position, size, layoutKind, style), texture(texture),
+        imageSourceRect(source) {}
+
   void draw(LayoutState &state) override {
-    Rectangle destRect;
+    Rectangle destRect = {};
     state.applyFillToRect(fillType, imageSourceRect, destRect);
     state.applyVAlignmentToRect(vAlignment, destRect);
     state.applyHAlignmentToRect(hAlignment, destRect);
-    DrawTexturePro(texture, imageSourceRect, destRect, origin, rotation,
-                   style.foreground);
+    drawList().texture(texture, imageSourceRect, destRect, style.foreground,
+                       origin, rotation);
   }
   ~Image() {
     if (loadedFromPath)
@@ -369,9 +907,20 @@ struct NumberText : Element {
   Color color;
   NumberText(Position position, Size size, size_t *number, Color color)
       : Element(position, size), number(number), color(color) {}
+
+  // the number as it was last drawn, and it's text. it's only formatted again
+  // when the number changes.
+  size_t shown = 0;
+  char text[24] = "0";
+  bool changed() const override { return dirty || *number != shown; }
+
   virtual void draw(LayoutState &state) override {
-    DrawText(std::to_string(*number).c_str(), state.position.x,
-             state.position.y, state.size.height, color);
+    if (*number != shown) {
+      shown = *number;
+      *std::to_chars(text, text + sizeof(text) - 1, shown).ptr = '\0';
+    }
+    drawList().text(text, state.position.x, state.position.y,
+                    state.size.height, color);
   }
 };
 
@@ -383,28 +932,31 @@ struct TimeText : Element {
   TimeText(Position position, Size size, std::chrono::milliseconds *time,
            Color color)
       : Element(position, size), time(time), color(color) {}
+
+  // it only shows whole seconds, so it's only formatted again when they
+  // change.
+  long long shownSeconds = -1;
+  char text[32] = "";
+  bool changed() const override {
+    return dirty || (*time).count() / 1000 != shownSeconds;
+  }
+
   virtual void draw(LayoutState &state) override {
-    auto totalMilliseconds = (*this->time).count() / 1000;
-    int hours = totalMilliseconds / 3600;
-    int minutes = (totalMilliseconds % 3600) / 60;
-    int seconds = totalMilliseconds % 60;
-
-    std::string timeStr;
-    if (hours > 0) {
-      timeStr = std::to_string(hours) + ":" +
-                std::to_string(minutes).insert(
-                    0, 2 - std::to_string(minutes).length(), '0') +
-                ":" +
-                std::to_string(seconds).insert(
-                    0, 2 - std::to_string(seconds).length(), '0');
-    } else {
-      timeStr = std::to_string(minutes) + ":" +
-                std::to_string(seconds).insert(
-                    0, 2 - std::to_string(seconds).length(), '0');
+    auto totalSeconds = (*time).count() / 1000;
+    if (totalSeconds != shownSeconds) {
+      shownSeconds = totalSeconds;
+      int hours = totalSeconds / 3600;
+      int minutes = (totalSeconds % 3600) / 60;
+      int seconds = totalSeconds % 60;
+      if (hours > 0) {
+        snprintf(text, sizeof(text), "%d:%02d:%02d", hours, minutes, seconds);
+      } else {
+        snprintf(text, sizeof(text), "%d:%02d", minutes, seconds);
+      }
     }
 
-    DrawText(timeStr.c_str(), state.position.x, state.position.y,
-             state.size.height, color);
+    drawList().text(text, state.position.x, state.position.y,
+                    state.size.height, color);
   }
 };
 
@@ -419,6 +971,10 @@ struct Slider : Element {
         onValueChanged(onValueChanged) {}
 
   Slider(Position position, Size size) : Element(position, size) {}
+
+  // it has to see the mouse every frame.
+  bool changed() const override { return true; }
+
   float min = 0, max = 1;
   float value = 0;
 
@@ -487,82 +1043,276 @@ struct Slider : Element {
       handlePosition = {state.position.x + normalizedValue * effectiveWidth +
                             handleRadius,
                         state.position.y + barHeight / 2};
-      DrawRectangle(state.position.x, state.position.y,
-                    state.size.width * barWidth, barHeight, style.background);
+      drawList().rectangle(state.position.x, state.position.y,
+                           state.size.width * barWidth, barHeight,
+                           style.background);
     } else {
       float effectiveHeight = state.size.height * barHeight - 2 * handleRadius;
       handlePosition = {state.position.x + barWidth / 2,
                         state.position.y + normalizedValue * effectiveHeight +
                             handleRadius};
-      DrawRectangle(state.position.x, state.position.y, barWidth,
-                    state.size.height * barHeight, style.background);
+      drawList().rectangle(state.position.x, state.position.y, barWidth,
+                           state.size.height * barHeight, style.background);
     }
 
-    DrawCircle(handlePosition.x, handlePosition.y, handleRadius,
-               style.foreground);
+    drawList().circle(handlePosition.x, handlePosition.y, handleRadius,
+                      style.foreground);
 
     handleDragging(state, currentMousePos, handlePosition);
 
     if (label) {
-      auto label = *this->label;
-      auto size = MeasureText(label.c_str(), fontSize);
+      const auto &label = *this->label;
 
       if (orientation == Orientation::Horizontal) {
-        DrawText(label.c_str(), state.position.x, state.position.y - fontSize,
-                 fontSize, style.foreground);
+        drawList().text(label.c_str(), state.position.x,
+                        state.position.y - fontSize, fontSize,
+                        style.foreground);
       } else {
         float currentY = state.position.y;
         for (char c : label) {
           std::string charStr(1, c);
-          DrawText(charStr.c_str(), state.position.x + barWidth + 5, currentY,
-                   fontSize, style.foreground); // Adjusted for spacing
+          drawList().text(charStr.c_str(), state.position.x + barWidth + 5,
+                          currentY, fontSize,
+                          style.foreground); // Adjusted for spacing
           currentY += fontSize;
         }
       }
     }
   }
 };
-struct AnimatedImage : Element {
-  AnimatedImage(Position pos, Size size, std::vector<std::string> paths)
-      : Element(pos, size) {
-    for (const auto &path : paths) {
-      frames.push_back(LoadTexture(path.c_str()));
-    }
-    std::reverse(frames.begin(), frames.end());
-    loadedFromPaths = true;
-  };
-  AnimatedImage(Position pos, Size size, std::vector<Texture2D> images)
-      : Element(pos, size), frames(images) {
-  };
-  
-  
-  ~AnimatedImage() {
-    if (loadedFromPaths) {
-      for (auto &tex : frames) {
-        UnloadTexture(tex);
-      }
+// an image flipping through frames from one texture. each keeps it's own
+// time, so several play at their own pace.
+struct AnimatedImage : Image {
+  // frames from `texture`, like an `Atlas`'s.
+  AnimatedImage(Position pos, Size size, Texture2D texture,
+                std::vector<Rectangle> frames)
+      : Image(pos, size, texture, frames.at(0)), frames(std::move(frames)) {}
+  // frames loaded from `paths`, last first, packed into an atlas of their
+  // own.
+  AnimatedImage(Position pos, Size size, const std::vector<std::string> &paths)
+      : Image(pos, size, Texture2D{}, Rectangle{}),
+        atlas(std::make_unique<Atlas>()) {
+    for (auto path = paths.rbegin(); path != paths.rend(); ++path) {
+      atlas->load(path->c_str());
+    }
+    atlas->build();
+    texture = atlas->texture;
+    for (size_t i = 0; i < paths.size(); ++i) {
+      frames.push_back(atlas->source(i));
     }
+    imageSourceRect = frames.at(0);
   }
 
-  bool loadedFromPaths;
   int frame = 0;
+  // frames a second.
   float framerateScale = 1.0f;
-  std::vector<Texture2D> frames = {};
+  std::vector<Rectangle> frames = {};
+
+  bool changed() const override { return true; }
 
   void draw(LayoutState &state) override {
-    static double lastTime = 0;
-    double currentTime = GetTime();
-    double elapsedTime = currentTime - lastTime;
-    
-    double frameDuration = 1.0 / framerateScale;
-    
-    if (elapsedTime >= frameDuration) {
-      frame = (frame + 1) % frames.size();
-      lastTime = currentTime;
-    }
-
-    auto image = rayui::Image{position, size, frames[frame]};
-    image.draw(state);
+    double now = GetTime();
+    if (lastTime < 0) {
+      lastTime = now;
+    }
+    // a slow frame skips ahead, instead of the animation falling behind.
+    const double frameDuration = 1.0 / framerateScale;
+    if (now - lastTime >= frameDuration) {
+      auto steps = (int)((now - lastTime) / frameDuration);
+      frame = (frame + steps) % frames.size();
+      lastTime += steps * frameDuration;
+      imageSourceRect = frames[frame];
+    }
+    Image::draw(state);
+  }
+
+private:
+  std::unique_ptr<Atlas> atlas;
+  // when the frame showing started.
+  double lastTime = -1;
+};
+
+// puts a `DrawList` on screen with raylib. the frame is drawn into a texture
+// and kept, so a frame that's the same as the last one is just that texture
+// again.
+struct RaylibBackend {
+  RaylibBackend() = default;
+  RaylibBackend(const RaylibBackend &) = delete;
+  RaylibBackend &operator=(const RaylibBackend &) = delete;
+  ~RaylibBackend() {
+    if (frame.id != 0) {
+      UnloadRenderTexture(frame);
+    }
+  }
+
+  // whether the last frame presented was the same as the one before it.
+  bool skipped = false;
+  size_t framesSkipped = 0;
+
+  // call between BeginDrawing and EndDrawing.
+  void present(const DrawList &list) {
+    int width = list.width, height = list.height;
+    bool resized = frame.id == 0 || frame.texture.width != width ||
+                   frame.texture.height != height;
+    if (resized) {
+      if (frame.id != 0) {
+        UnloadRenderTexture(frame);
+      }
+      frame = LoadRenderTexture(width, height);
+    }
+
+    skipped = !resized && list == previous;
+    if (skipped) {
+      framesSkipped++;
+    } else {
+      // raylib can only draw into one texture at a time, so every layer is
+      // drawn before the frame. inner layers end first, so they're ready by
+      // the time the layer around them is drawn.
+      for (uint32_t i = 0; i < list.commands.size(); ++i) {
+        const auto &command = list.commands[i];
+        if (command.kind == DrawCommand::Kind::EndLayer) {
+          const auto &begin = list.commands[command.index];
+          BeginTextureMode(list.targets[begin.index]);
+          submit(list, command.index + 1, i);
+          EndTextureMode();
+        }
+      }
+      BeginTextureMode(frame);
+      ClearBackground(BLANK);
+      submit(list, 0, list.commands.size());
+      EndTextureMode();
+      previous = list;
+    }
+
+    // what's blended into the frame is already blended, copy it as it is.
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    DrawTextureRec(frame.texture, {0, 0, (float)width, -(float)height},
+                   {0, 0}, WHITE);
+    EndBlendMode();
+  }
+
+private:
+  RenderTexture2D frame = {};
+  DrawList previous;
+
+  // draws the commands in [from, to), skipping over layers.
+  static void submit(const DrawList &list, uint32_t from, uint32_t to) {
+    for (uint32_t i = from; i < to; ++i) {
+      const auto &command = list.commands[i];
+      const auto &dest = command.dest;
+      switch (command.kind) {
+      case DrawCommand::Kind::Clear:
+        ClearBackground(command.color);
+        break;
+      case DrawCommand::Kind::Rect:
+        DrawRectangleRec(dest, command.color);
+        break;
+      case DrawCommand::Kind::RectLines:
+        DrawRectangleLinesEx(dest, command.value, command.color);
+        break;
+      case DrawCommand::Kind::Circle:
+        DrawCircle(dest.x, dest.y, dest.width, command.color);
+        break;
+      case DrawCommand::Kind::Texture:
+        i = submitTextures(list, i, to) - 1;
+        break;
+      case DrawCommand::Kind::Text:
+        DrawText(list.strings.data() + command.index, dest.x, dest.y,
+                 command.value, command.color);
+        break;
+      case DrawCommand::Kind::Rects:
+        submitRects(list, command.index, command.end);
+        break;
+      case DrawCommand::Kind::BeginLayer:
+        i = command.end;
+        break;
+      case DrawCommand::Kind::EndLayer:
+        break;
+      }
+    }
+  }
+
+  // draws a batch of plain rectangles as untextured quads, as many to a
+  // batch as raylib's vertex buffer takes.
+  static void submitRects(const DrawList &list, uint32_t from, uint32_t to) {
+    constexpr uint32_t perBatch = 4096;
+    for (auto start = from; start < to; start += perBatch) {
+      auto end = std::min(to, start + perBatch);
+      rlCheckRenderBatchLimit(4 * (end - start));
+      rlSetTexture(rlGetTextureIdDefault());
+      rlBegin(RL_QUADS);
+      rlNormal3f(0, 0, 1);
+      for (auto i = start; i < end; ++i) {
+        const auto &[rect, color] = list.batchRects[i];
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        rlTexCoord2f(0, 0);
+        rlVertex2f(rect.x, rect.y);
+        rlTexCoord2f(0, 1);
+        rlVertex2f(rect.x, rect.y + rect.height);
+        rlTexCoord2f(1, 1);
+        rlVertex2f(rect.x + rect.width, rect.y + rect.height);
+        rlTexCoord2f(1, 0);
+        rlVertex2f(rect.x + rect.width, rect.y);
+      }
+      rlEnd();
+      rlSetTexture(0);
+    }
+  }
+
+  // draws the run of unrotated quads from one texture starting at `from` in
+  // one go, like a sprite batch. returns where the run ends.
+  static uint32_t submitTextures(const DrawList &list, uint32_t from,
+                                 uint32_t to) {
+    const auto &first = list.commands[from];
+    if (first.value != 0 || first.origin.x != 0 || first.origin.y != 0) {
+      DrawTexturePro(first.texture, first.source, first.dest, first.origin,
+                     first.value, first.color);
+      return from + 1;
+    }
+    auto end = from;
+    while (end < to && list.commands[end].kind == DrawCommand::Kind::Texture &&
+           list.commands[end].texture.id == first.texture.id &&
+           list.commands[end].value == 0 && list.commands[end].origin.x == 0 &&
+           list.commands[end].origin.y == 0) {
+      end++;
+    }
+
+    const float width = first.texture.width, height = first.texture.height;
+    rlCheckRenderBatchLimit(4 * (end - from));
+    rlSetTexture(first.texture.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0, 0, 1);
+    for (auto i = from; i < end; ++i) {
+      const auto &command = list.commands[i];
+      auto source = command.source;
+      const auto &dest = command.dest;
+      // a negative size flips the image that way.
+      float left = source.x / width, right = (source.x + source.width) / width;
+      float top = source.y / height,
+            bottom = (source.y + source.height) / height;
+      if (source.width < 0) {
+        left = (source.x - source.width) / width;
+        right = source.x / width;
+      }
+      if (source.height < 0) {
+        top = (source.y - source.height) / height;
+        bottom = source.y / height;
+      }
+      rlColor4ub(command.color.r, command.color.g, command.color.b,
+                 command.color.a);
+      rlTexCoord2f(left, top);
+      rlVertex2f(dest.x, dest.y);
+      rlTexCoord2f(left, bottom);
+      rlVertex2f(dest.x, dest.y + dest.height);
+      rlTexCoord2f(right, bottom);
+      rlVertex2f(dest.x + dest.width, dest.y + dest.height);
+      rlTexCoord2f(right, top);
+      rlVertex2f(dest.x + dest.width, dest.y);
+    }
+    rlEnd();
+    rlSetTexture(0);
+    return end;
   }
 };
 
@@ -0,0 +1,151 @@
+// draws games frame by frame like the window does, but into memory on the cpu
+// with rayui's software backend, so it runs without a gpu or a display.
+// reports what a frame costs to record and to rasterize, and saves the last
+// frame of each as a png if given somewhere to put them. the last one is a
+// screen full of particles.
+//
+// usage: boom_tetris_render_bench [frames] [width] [height] [png prefix]
+
+#include "software_backend.hpp"
+#include "versus.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+using namespace boom_tetris;
+using Clock = std::chrono::steady_clock;
+
+static void run(const char *name, int frames, int width, int height,
+                const Assets &assets, const char *pngPrefix,
+                const std::function<void()> &step,
+                const std::function<void()> &draw) {
+  rayui::SoftwareBackend backend;
+  backend.addTexture(assets.atlas.texture, assets.atlas.image);
+  auto &list = rayui::drawList();
+
+  std::chrono::nanoseconds recording{0}, rasterizing{0}, slowest{0};
+  long drawCalls = 0, textureSwitches = 0, textDraws = 0;
+  for (int i = 0; i < frames; ++i) {
+    step();
+    auto started = Clock::now();
+    list.reset(width, height);
+    draw();
+    auto recorded = Clock::now();
+    backend.present(list);
+    auto presented = Clock::now();
+
+    recording += recorded - started;
+    if (!backend.skipped) {
+      rasterizing += presented - recorded;
+      slowest = std::max<std::chrono::nanoseconds>(slowest,
+                                                   presented - recorded);
+    }
+    drawCalls += list.counters.drawCalls;
+    textureSwitches += list.counters.textureSwitches;
+    textDraws += list.counters.textDraws;
+  }
+
+  auto micros = [](std::chrono::nanoseconds ns, long count) {
+    return count ? ns.count() / 1e3 / count : 0.0;
+  };
+  long drawn = frames - backend.framesSkipped;
+  printf("%s: %d frames at %dx%d\n", name, frames, width, height);
+  printf("  record %.2f us/frame, rasterize %.1f us/frame (slowest %.1f us)\n",
+         micros(recording, frames), micros(rasterizing, drawn),
+         micros(slowest, 1));
+  printf("  %zu frames the same as the one before and skipped\n",
+         backend.framesSkipped);
+  printf("  per frame: %.1f draw calls, %.1f texture switches, %.1f text\n",
+         double(drawCalls) / frames, double(textureSwitches) / frames,
+         double(textDraws) / frames);
+
+  if (pngPrefix) {
+    auto path = std::string(pngPrefix) + "-" + name + ".png";
+    if (!backend.exportPng(path.c_str())) {
+      fprintf(stderr, "couldn't write %s\n", path.c_str());
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int frames = 60 * 60;
+  int width = 800, height = 600;
+  const char *pngPrefix = nullptr;
+  if (argc > 1) {
+    frames = std::atoi(argv[1]);
+  }
+  if (argc > 2) {
+    width = std::atoi(argv[2]);
+  }
+  if (argc > 3) {
+    height = std::atoi(argv[3]);
+  }
+  if (argc > 4) {
+    pngPrefix = argv[4];
+  }
+
+  // no window: the assets keep their atlas on the cpu.
+  SetTraceLogLevel(LOG_WARNING);
+  auto assets = std::make_shared<Assets>();
+
+  Game game(assets);
+  game.silent = true;
+  game.reset();
+  game.scene = Game::Scene::InGame;
+  Bot bot;
+  run(
+      "solo", frames, width, height, *assets, pngPrefix,
+      [&] {
+        if (game.scene != Game::Scene::InGame) {
+          game.reset();
+          game.scene = Game::Scene::InGame;
+        }
+        game.processGameLogic(bot.play(game));
+      },
+      [&] { game.drawGame(); });
+
+  Versus versus(assets);
+  auto startVersus = [&] {
+    versus.start(Versus::maxBoards, 1);
+    for (auto &player : versus.players) {
+      player.controller = Versus::Controller::Bot;
+      player.game->silent = true;
+    }
+  };
+  startVersus();
+  run(
+      "versus", frames, width, height, *assets, pngPrefix,
+      [&] {
+        if (versus.winner) {
+          startVersus();
+        }
+        versus.processGameLogic();
+      },
+      [&] { versus.draw(); });
+
+  // a screen kept full of particles, far more than the game ever throws about.
+  Particles particles;
+  particles.limit = 20000;
+  particles.gravity = 200;
+  particles.bottom = height;
+  run(
+      "particles", frames, width, height, *assets, pngPrefix,
+      [&] {
+        particles.emit(particles.limit,
+                       {.area = {0, 0, (float)width, (float)height / 2},
+                        .minVelocity = {-100, -200},
+                        .maxVelocity = {100, 0},
+                        .minSize = 1,
+                        .maxSize = 4,
+                        .minLife = 0.5f,
+                        .maxLife = 2});
+        particles.update(1 / 60.0f);
+      },
+      [&] {
+        rayui::drawList().clearBackground(BLACK);
+        particles.draw(rayui::drawList());
+      });
+  return 0;
+}
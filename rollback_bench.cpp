@@ -0,0 +1,96 @@
+// plays two rollback netplay sessions against each other over udp on
+// localhost, with bots on both ends and a made up bad network in between, and
+// reports how much rolling back that took and whether the two sides agreed.
+//
+// usage: boom_tetris_rollback_bench [frames] [latency ms] [jitter ms] [loss %]
+
+#include "netplay.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace boom_tetris;
+
+static void report(const char *name, const Netplay &netplay,
+                   std::chrono::nanoseconds slowestUpdate) {
+  const auto &stats = netplay.stats;
+  auto micros = [](std::chrono::nanoseconds ns) { return ns.count() / 1e3; };
+  printf("%s: frame %d, player %d\n", name, netplay.frame,
+         netplay.localPlayer + 1);
+  printf("  rollbacks %zu, frames resimulated %zu (avg %.2f, deepest %d)\n",
+         stats.rollbacks, stats.resimulatedFrames,
+         stats.rollbacks ? double(stats.resimulatedFrames) / stats.rollbacks
+                         : 0.0,
+         stats.deepestRollback);
+  printf("  rollback time avg %.1f us, slowest %.1f us (a frame is 16667 us)\n",
+         stats.rollbacks ? micros(stats.rollbackTime) / stats.rollbacks : 0.0,
+         micros(stats.slowestRollback));
+  printf("  slowest update %.1f us, stalled frames %zu\n", micros(slowestUpdate),
+         stats.stalls);
+  printf("  checksums compared %zu, desyncs %zu\n", stats.checksumsCompared,
+         stats.desyncs);
+}
+
+int main(int argc, char *argv[]) {
+  int frames = 60 * 60;
+  int latency = 50, jitter = 10, loss = 5;
+  if (argc > 1) {
+    frames = std::atoi(argv[1]);
+  }
+  if (argc > 2) {
+    latency = std::atoi(argv[2]);
+  }
+  if (argc > 3) {
+    jitter = std::atoi(argv[3]);
+  }
+  if (argc > 4) {
+    loss = std::atoi(argv[4]);
+  }
+
+  // the games load their textures and sounds, which needs a window.
+  SetTraceLogLevel(LOG_WARNING);
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  InitWindow(64, 64, "boom_tetris_rollback_bench");
+  auto assets = std::make_shared<Assets>();
+
+  constexpr uint16_t portA = 47011, portB = 47012;
+  Netplay a(assets, portA, {0x7f000001, portB}, 0xa11ce);
+  Netplay b(assets, portB, {0x7f000001, portA}, 0xb0b);
+  for (auto *netplay : {&a, &b}) {
+    netplay->connection.latency = std::chrono::milliseconds(latency);
+    netplay->connection.jitter = std::chrono::milliseconds(jitter);
+    netplay->connection.lossPercent = loss;
+  }
+  if (!a.connection.socket.valid() || !b.connection.socket.valid()) {
+    fprintf(stderr, "couldn't open udp ports %d and %d\n", portA, portB);
+    return 1;
+  }
+
+  Bot botA, botB;
+  std::chrono::nanoseconds slowestA{0}, slowestB{0};
+  // the clock the fake network runs on ticks a frame per update, so this runs
+  // as fast as it can while the latency still means what it says.
+  auto now = Netplay::Clock::now();
+  for (int i = 0; i < frames; ++i) {
+    now += std::chrono::microseconds(16667);
+    for (auto [netplay, bot, slowest] :
+         {std::tuple{&a, &botA, &slowestA}, std::tuple{&b, &botB, &slowestB}}) {
+      InputFrame input;
+      if (netplay->state == Netplay::State::Playing) {
+        input = bot->play(*netplay->versus.players[netplay->localPlayer].game);
+      }
+      auto started = Netplay::Clock::now();
+      netplay->update(input, now);
+      *slowest = std::max<std::chrono::nanoseconds>(
+          *slowest, Netplay::Clock::now() - started);
+    }
+  }
+
+  printf("%d frames, %d ms latency, %d ms jitter, %d%% loss each way\n",
+         frames, latency, jitter, loss);
+  report("a", a, slowestA);
+  report("b", b, slowestB);
+
+  CloseWindow();
+  return a.stats.desyncs + b.stats.desyncs > 0 ? 1 : 0;
+}
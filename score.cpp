@@ -1,4 +1,5 @@
 #include "score.hpp"
+#include "log.hpp"
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -7,7 +8,6 @@
 #ifdef _WIN32
 #include "windows.h"
 #endif
-#include <iostream>
 
 
 void ScoreFile::read() {
@@ -46,12 +46,12 @@ std::string ScoreFile::getScoreFilePath() {
 #ifdef _WIN32
   auto appDataPath = std::getenv("APPDATA");
 
-  std::cout << "appDataPath: " << appDataPath << std::endl;
+  boom_tetris::logDebug("appDataPath: {}", appDataPath ? appDataPath : "");
 
   if (appDataPath != nullptr) {
     path = std::filesystem::path(appDataPath) / "boom_tetris" / "score";
   }
-  std::cout << "configPath: " << path << std::endl;
+  boom_tetris::logDebug("configPath: {}", path.string());
 
 #else
   auto homePath = std::getenv("HOME");
@@ -74,9 +74,11 @@ void ScoreFile::createDirectoryAndFile(const std::string &path) {
     if (!std::filesystem::exists(dirPath)) {
       bool created = std::filesystem::create_directories(dirPath);
       if (created) {
-        std::cout << "Directory created successfully: " << dirPath << std::endl;
+        boom_tetris::logInfo("Directory created successfully: {}",
+                             dirPath.string());
       } else {
-        std::cerr << "Failed to create directory: " << dirPath << std::endl;
+        boom_tetris::logError("Failed to create directory: {}",
+                              dirPath.string());
         return;
       }
     }
@@ -85,14 +87,15 @@ void ScoreFile::createDirectoryAndFile(const std::string &path) {
     if (!std::filesystem::exists(filePath)) {
       std::ofstream file(path);
       if (file) {
-        std::cout << "File created successfully: " << filePath << std::endl;
+        boom_tetris::logInfo("File created successfully: {}",
+                             filePath.string());
       } else {
-        std::cerr << "Failed to create file: " << filePath << std::endl;
+        boom_tetris::logError("Failed to create file: {}", filePath.string());
       }
     }
   } catch (const std::filesystem::filesystem_error &e) {
-    std::cerr << "Filesystem error: " << e.what() << std::endl;
+    boom_tetris::logError("Filesystem error: {}", e.what());
   } catch (const std::exception &e) {
-    std::cerr << "General error: " << e.what() << std::endl;
+    boom_tetris::logError("General error: {}", e.what());
   }
 }
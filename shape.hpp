@@ -0,0 +1,11 @@
+#pragma once
+
+namespace boom_tetris {
+
+// the shape of a tetromino, a group of cells.
+enum struct Shape { L, J, Z, S, I, T, O };
+
+// how many distinct shapes there are, for tables indexed by `Shape`.
+constexpr int shapeCount = (int)Shape::O + 1;
+
+} // namespace boom_tetris
@@ -0,0 +1,122 @@
+#include "simulation.hpp"
+#include <algorithm>
+
+using namespace boom_tetris;
+
+Simulation::Simulation(std::shared_ptr<Assets> assets)
+    : game(std::move(assets)) {
+  game.deferCues = true;
+  game.effects = false;
+}
+
+Simulation::~Simulation() { stop(); }
+
+void Simulation::start(const Game &shown) {
+  // the settings and scores that aren't part of a snapshot.
+  game.mode = shown.mode;
+  game.startLevel = shown.startLevel;
+  game.bagelMode = shown.bagelMode;
+  game.turbo = shown.turbo;
+  game.scoreFile = shown.scoreFile;
+  Game::Snapshot snapshot;
+  shown.save(snapshot);
+  game.load(snapshot);
+  game.cues.clear();
+
+  shownFrame = shown.frameCount;
+  shownAt = Clock::now();
+  shownPressedAt = {};
+  pressedAt = 0;
+  stopping = false;
+  thread = std::thread([this] { run(); });
+}
+
+void Simulation::stop() {
+  if (!thread.joinable()) {
+    return;
+  }
+  stopping = true;
+  thread.join();
+  published.update();
+  while (cues.pop()) {
+  }
+}
+
+float Simulation::present(Game &shown) {
+  if (!running() || shown.frameCount < shownFrame) {
+    stop();
+    start(shown);
+  }
+
+  pressShown.reset();
+  if (published.update()) {
+    const auto &[snapshot, at, pressed] = published.front();
+    auto before = shown.tetromino;
+    auto frame = shown.frameCount;
+    shown.load(snapshot);
+    // the piece only slides from where it was if this is the very next tick.
+    shown.pieceBefore =
+        shown.frameCount == frame + 1 ? before : std::nullopt;
+    shownFrame = shown.frameCount;
+    shownAt = at;
+    if (pressed > shownPressedAt) {
+      shownPressedAt = pressed;
+      pressShown = pressed;
+    }
+  }
+  while (auto cue = cues.pop()) {
+    shown.play(*cue);
+  }
+  // the thread stops itself right after publishing the tick that ended the
+  // game, so once that's shown it's scores can be taken back. it has to be
+  // now: the next frame is on the game over screen, which stops the thread
+  // and would throw them away.
+  if (shown.scene != Game::Scene::InGame) {
+    thread.join();
+    shown.scoreFile = game.scoreFile;
+  }
+
+  std::chrono::duration<float> since = Clock::now() - shownAt;
+  return std::clamp(since.count() * (float)Game::tickRate, 0.0f, 1.0f);
+}
+
+void Simulation::run() {
+  tracer().nameThread("simulation");
+  const auto tick = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1 / Game::tickRate));
+  auto due = Clock::now();
+  Clock::time_point lastPress = {};
+  while (!stopping.load(std::memory_order_relaxed)) {
+    InputFrame input;
+    input.held = held.load(std::memory_order_relaxed) |
+                 tapped.exchange(0, std::memory_order_relaxed);
+    if (auto pressed = pressedAt.exchange(0, std::memory_order_relaxed)) {
+      lastPress = Clock::time_point(Clock::duration(pressed));
+    }
+    game.processGameLogic(input);
+    for (const auto &cue : game.cues) {
+      // with nobody taking them, the oldest would be stale anyway.
+      cues.push(cue);
+    }
+    game.cues.clear();
+
+    auto &back = published.back();
+    game.save(back.snapshot);
+    back.at = Clock::now();
+    back.pressedAt = lastPress;
+    published.publish();
+
+    if (game.scene != Game::Scene::InGame) {
+      break;
+    }
+    // after a stall, like the machine sleeping, carry on from now instead of
+    // racing to catch up.
+    due += tick;
+    auto now = Clock::now();
+    if (now - due > 8 * tick) {
+      due = now;
+    }
+    next.store(due.time_since_epoch().count(), std::memory_order_relaxed);
+    std::this_thread::sleep_until(due);
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "spsc_queue.hpp"
+#include "tetris.hpp"
+#include "triple_buffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace boom_tetris {
+
+// plays a solo game on a thread of it's own at the game's tick rate, so a slow
+// frame or a stall waiting on the display never holds up the game, or makes
+// delayed auto shift miss a beat. the game on screen is a copy, brought up to
+// date from a snapshot the thread publishes every tick.
+class Simulation {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Simulation(std::shared_ptr<Assets> assets);
+  ~Simulation();
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  // what the player is holding, from whichever thread has the window, read
+  // from input polled at `at`. a button tapped between two ticks is still
+  // seen by the next one.
+  void setInput(InputFrame input, Clock::time_point at = Clock::now()) {
+    if (input.held & ~posted.held) {
+      // only the first press the next tick takes is timed.
+      int64_t none = 0;
+      pressedAt.compare_exchange_strong(none, at.time_since_epoch().count(),
+                                        std::memory_order_relaxed);
+    }
+    posted = input;
+    held.store(input.held, std::memory_order_relaxed);
+    tapped.fetch_or(input.held, std::memory_order_relaxed);
+  }
+
+  // brings `shown` up to date with the newest tick and plays what it set off.
+  // the game starts from `shown` if it isn't running, or if `shown` was reset
+  // since. returns how far drawing is from that tick to the next, from 0 to 1.
+  float present(Game &shown);
+  // stops the game, throwing away the ticks that haven't been shown yet.
+  void stop();
+  bool running() const { return thread.joinable(); }
+  // when the next tick is due to read input.
+  Clock::time_point nextTick() const {
+    return Clock::time_point(
+        Clock::duration(next.load(std::memory_order_relaxed)));
+  }
+  // set by `present` when the tick it brought the game up to is the first to
+  // act on a press, to when the press was polled.
+  std::optional<Clock::time_point> pressShown;
+
+private:
+  struct Published {
+    Game::Snapshot snapshot;
+    Clock::time_point at;
+    // when the latest press any tick so far acted on was polled.
+    Clock::time_point pressedAt;
+  };
+
+  // only touched by the thread while it's running.
+  Game game;
+  std::thread thread;
+  std::atomic<bool> stopping = false;
+  std::atomic<uint8_t> held = 0, tapped = 0;
+  // in ticks of `Clock`, 0 for none.
+  std::atomic<int64_t> pressedAt = 0, next = 0;
+  // the input last posted, to tell presses apart. only for the window's
+  // thread.
+  InputFrame posted;
+  TripleBuffer<Published> published;
+  SpscQueue<Game::Cue, 256> cues;
+  // the tick `shown` was last brought up to, and when it was published.
+  size_t shownFrame = 0;
+  Clock::time_point shownAt, shownPressedAt;
+
+  void start(const Game &shown);
+  void run();
+};
+
+} // namespace boom_tetris
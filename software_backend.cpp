@@ -0,0 +1,477 @@
+#include "software_backend.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAYUI_SSE2 1
+#endif
+
+using namespace rayui;
+
+namespace {
+
+// printable ascii, from ' ' on. each row is 5 pixels, the lowest bit on the
+// left.
+constexpr uint8_t glyphs[95][7] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}, // !
+    {0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00}, // "
+    {0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a}, // #
+    {0x04, 0x1e, 0x05, 0x0e, 0x14, 0x0f, 0x04}, // $
+    {0x03, 0x13, 0x08, 0x04, 0x02, 0x19, 0x18}, // %
+    {0x06, 0x09, 0x05, 0x02, 0x15, 0x09, 0x16}, // &
+    {0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00}, // '
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, // (
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, // )
+    {0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00}, // *
+    {0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00}, // +
+    {0x00, 0x00, 0x00, 0x00, 0x06, 0x04, 0x02}, // ,
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00}, // -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x06}, // .
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, // /
+    {0x0e, 0x11, 0x19, 0x15, 0x13, 0x11, 0x0e}, // 0
+    {0x04, 0x06, 0x04, 0x04, 0x04, 0x04, 0x0e}, // 1
+    {0x0e, 0x11, 0x10, 0x08, 0x04, 0x02, 0x1f}, // 2
+    {0x1f, 0x08, 0x04, 0x08, 0x10, 0x11, 0x0e}, // 3
+    {0x08, 0x0c, 0x0a, 0x09, 0x1f, 0x08, 0x08}, // 4
+    {0x1f, 0x01, 0x0f, 0x10, 0x10, 0x11, 0x0e}, // 5
+    {0x0c, 0x02, 0x01, 0x0f, 0x11, 0x11, 0x0e}, // 6
+    {0x1f, 0x10, 0x08, 0x04, 0x02, 0x02, 0x02}, // 7
+    {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e}, // 8
+    {0x0e, 0x11, 0x11, 0x1e, 0x10, 0x08, 0x06}, // 9
+    {0x00, 0x06, 0x06, 0x00, 0x06, 0x06, 0x00}, // :
+    {0x00, 0x06, 0x06, 0x00, 0x06, 0x04, 0x02}, // ;
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, // <
+    {0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00}, // =
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, // >
+    {0x0e, 0x11, 0x10, 0x08, 0x04, 0x00, 0x04}, // ?
+    {0x0e, 0x11, 0x10, 0x16, 0x15, 0x15, 0x0e}, // @
+    {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}, // A
+    {0x0f, 0x11, 0x11, 0x0f, 0x11, 0x11, 0x0f}, // B
+    {0x0e, 0x11, 0x01, 0x01, 0x01, 0x11, 0x0e}, // C
+    {0x07, 0x09, 0x11, 0x11, 0x11, 0x09, 0x07}, // D
+    {0x1f, 0x01, 0x01, 0x0f, 0x01, 0x01, 0x1f}, // E
+    {0x1f, 0x01, 0x01, 0x0f, 0x01, 0x01, 0x01}, // F
+    {0x0e, 0x11, 0x01, 0x1d, 0x11, 0x11, 0x1e}, // G
+    {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}, // H
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}, // I
+    {0x1c, 0x08, 0x08, 0x08, 0x08, 0x09, 0x06}, // J
+    {0x11, 0x09, 0x05, 0x03, 0x05, 0x09, 0x11}, // K
+    {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1f}, // L
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11}, // M
+    {0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11}, // N
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, // O
+    {0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01, 0x01}, // P
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x09, 0x16}, // Q
+    {0x0f, 0x11, 0x11, 0x0f, 0x05, 0x09, 0x11}, // R
+    {0x1e, 0x01, 0x01, 0x0e, 0x10, 0x10, 0x0f}, // S
+    {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // T
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}, // U
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04}, // V
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a}, // W
+    {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11}, // X
+    {0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04}, // Y
+    {0x1f, 0x10, 0x08, 0x04, 0x02, 0x01, 0x1f}, // Z
+    {0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e}, // [
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // backslash
+    {0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e}, // ]
+    {0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00}, // ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f}, // _
+    {0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00}, // `
+    {0x00, 0x00, 0x0e, 0x10, 0x1e, 0x11, 0x1e}, // a
+    {0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f}, // b
+    {0x00, 0x00, 0x0e, 0x01, 0x01, 0x11, 0x0e}, // c
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e}, // d
+    {0x00, 0x00, 0x0e, 0x11, 0x1f, 0x01, 0x0e}, // e
+    {0x0c, 0x12, 0x02, 0x07, 0x02, 0x02, 0x02}, // f
+    {0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x0e}, // g
+    {0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x11}, // h
+    {0x04, 0x00, 0x06, 0x04, 0x04, 0x04, 0x0e}, // i
+    {0x08, 0x00, 0x0c, 0x08, 0x08, 0x09, 0x06}, // j
+    {0x01, 0x01, 0x09, 0x05, 0x03, 0x05, 0x09}, // k
+    {0x06, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}, // l
+    {0x00, 0x00, 0x0b, 0x15, 0x15, 0x11, 0x11}, // m
+    {0x00, 0x00, 0x0d, 0x13, 0x11, 0x11, 0x11}, // n
+    {0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e}, // o
+    {0x00, 0x00, 0x0f, 0x11, 0x0f, 0x01, 0x01}, // p
+    {0x00, 0x00, 0x16, 0x19, 0x1e, 0x10, 0x10}, // q
+    {0x00, 0x00, 0x0d, 0x13, 0x01, 0x01, 0x01}, // r
+    {0x00, 0x00, 0x0e, 0x01, 0x0e, 0x10, 0x0f}, // s
+    {0x02, 0x02, 0x07, 0x02, 0x02, 0x12, 0x0c}, // t
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x19, 0x16}, // u
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04}, // v
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a}, // w
+    {0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11}, // x
+    {0x00, 0x00, 0x11, 0x11, 0x1e, 0x10, 0x0e}, // y
+    {0x00, 0x00, 0x1f, 0x08, 0x04, 0x02, 0x1f}, // z
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08}, // {
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // |
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02}, // }
+    {0x00, 0x00, 0x02, 0x15, 0x08, 0x00, 0x00}, // ~
+};
+// raylib's default font is 10 pixels tall, and text is scaled up from that.
+constexpr int fontBaseSize = 10;
+
+uint32_t pack(Color color) {
+  uint32_t pixel;
+  std::memcpy(&pixel, &color, sizeof(pixel));
+  return pixel;
+}
+Color unpack(uint32_t pixel) {
+  Color color;
+  std::memcpy(&color, &pixel, sizeof(pixel));
+  return color;
+}
+
+// x / 255, rounded, for x up to 255 * 255.
+inline unsigned div255(unsigned x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+#ifdef RAYUI_SSE2
+inline __m128i div255(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+// `color` over `dst`: each channel is color * a + dst * (255 - a), and the
+// alpha comes out as a + dst alpha * (255 - a), so a canvas that starts opaque
+// stays that way.
+void fillSpan(uint32_t *dst, int count, Color color) {
+  if (color.a == 255) {
+    std::fill_n(dst, count, pack(color));
+    return;
+  }
+  if (color.a == 0) {
+    return;
+  }
+  const unsigned a = color.a, inverse = 255 - a;
+  const unsigned r = color.r * a, g = color.g * a, b = color.b * a,
+                 alpha = 255 * a;
+  int i = 0;
+#ifdef RAYUI_SSE2
+  // 4 pixels at a time, widened to 16 bits a channel.
+  const __m128i source = _mm_setr_epi16(r, g, b, alpha, r, g, b, alpha);
+  const __m128i inverses = _mm_set1_epi16(inverse);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4 <= count; i += 4) {
+    auto pixels = _mm_loadu_si128((const __m128i *)(dst + i));
+    auto low = _mm_unpacklo_epi8(pixels, zero);
+    auto high = _mm_unpackhi_epi8(pixels, zero);
+    low = div255(_mm_add_epi16(_mm_mullo_epi16(low, inverses), source));
+    high = div255(_mm_add_epi16(_mm_mullo_epi16(high, inverses), source));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+  }
+#endif
+  for (; i < count; ++i) {
+    auto pixel = unpack(dst[i]);
+    pixel.r = div255(pixel.r * inverse + r);
+    pixel.g = div255(pixel.g * inverse + g);
+    pixel.b = div255(pixel.b * inverse + b);
+    pixel.a = div255(pixel.a * inverse + alpha);
+    dst[i] = pack(pixel);
+  }
+}
+
+// `src` over `dst`, like `fillSpan` but with a color per pixel.
+void blendSpan(uint32_t *dst, const uint32_t *src, int count) {
+  int i = 0;
+#ifdef RAYUI_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i alphaBytes = _mm_set1_epi32(0xff000000);
+  // the alpha lane of each pixel, once widened.
+  const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  for (; i + 4 <= count; i += 4) {
+    auto source = _mm_loadu_si128((const __m128i *)(src + i));
+    // the block sprites are solid, so most of the time it's just a copy.
+    auto opaque = _mm_cmpeq_epi32(_mm_and_si128(source, alphaBytes),
+                                  alphaBytes);
+    if (_mm_movemask_epi8(opaque) == 0xffff) {
+      _mm_storeu_si128((__m128i *)(dst + i), source);
+      continue;
+    }
+    auto pixels = _mm_loadu_si128((const __m128i *)(dst + i));
+    __m128i result[2];
+    for (int half = 0; half < 2; ++half) {
+      auto s = half ? _mm_unpackhi_epi8(source, zero)
+                    : _mm_unpacklo_epi8(source, zero);
+      auto d = half ? _mm_unpackhi_epi8(pixels, zero)
+                    : _mm_unpacklo_epi8(pixels, zero);
+      auto a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+      // the source's alpha counts as 255 when blending the alpha itself.
+      s = _mm_or_si128(s, alphaLanes);
+      result[half] =
+          div255(_mm_add_epi16(_mm_mullo_epi16(s, a),
+                               _mm_mullo_epi16(d, _mm_sub_epi16(full, a))));
+    }
+    _mm_storeu_si128((__m128i *)(dst + i),
+                     _mm_packus_epi16(result[0], result[1]));
+  }
+#endif
+  for (; i < count; ++i) {
+    auto source = unpack(src[i]);
+    if (source.a == 255) {
+      dst[i] = src[i];
+      continue;
+    }
+    auto pixel = unpack(dst[i]);
+    const unsigned a = source.a, inverse = 255 - a;
+    pixel.r = div255(source.r * a + pixel.r * inverse);
+    pixel.g = div255(source.g * a + pixel.g * inverse);
+    pixel.b = div255(source.b * a + pixel.b * inverse);
+    pixel.a = div255(255 * a + pixel.a * inverse);
+    dst[i] = pack(pixel);
+  }
+}
+
+// the pixels a rectangle covers: the ones whose centers are inside it.
+struct Span {
+  int x0, y0, x1, y1;
+};
+Span cover(const Canvas &canvas, Rectangle rect) {
+  return {std::max(0, (int)std::lround(rect.x)),
+          std::max(0, (int)std::lround(rect.y)),
+          std::min(canvas.width, (int)std::lround(rect.x + rect.width)),
+          std::min(canvas.height, (int)std::lround(rect.y + rect.height))};
+}
+
+void fillRect(Canvas &canvas, Rectangle rect, Color color) {
+  auto span = cover(canvas, rect);
+  for (int y = span.y0; y < span.y1; ++y) {
+    fillSpan(canvas.row(y) + span.x0, span.x1 - span.x0, color);
+  }
+}
+
+void fillCircle(Canvas &canvas, float cx, float cy, float radius,
+                Color color) {
+  int top = std::max(0, (int)std::floor(cy - radius));
+  int bottom = std::min(canvas.height, (int)std::ceil(cy + radius));
+  for (int y = top; y < bottom; ++y) {
+    float dy = y + 0.5f - cy;
+    if (dy * dy > radius * radius) {
+      continue;
+    }
+    float half = std::sqrt(radius * radius - dy * dy);
+    int x0 = std::max(0, (int)std::lround(cx - half));
+    int x1 = std::min(canvas.width, (int)std::lround(cx + half));
+    if (x1 > x0) {
+      fillSpan(canvas.row(y) + x0, x1 - x0, color);
+    }
+  }
+}
+
+// like raylib's DrawRectangleLinesEx: the top and bottom run the full width,
+// the sides fit between them.
+void strokeRect(Canvas &canvas, Rectangle rect, float thickness, Color color) {
+  thickness = std::min({thickness, rect.width / 2, rect.height / 2});
+  fillRect(canvas, {rect.x, rect.y, rect.width, thickness}, color);
+  fillRect(canvas,
+           {rect.x, rect.y + rect.height - thickness, rect.width, thickness},
+           color);
+  fillRect(canvas,
+           {rect.x, rect.y + thickness, thickness,
+            rect.height - 2 * thickness},
+           color);
+  fillRect(canvas,
+           {rect.x + rect.width - thickness, rect.y + thickness, thickness,
+            rect.height - 2 * thickness},
+           color);
+}
+
+// nearest neighbour, which is what the 8x8 block sprites want anyway.
+void drawTexture(Canvas &canvas, const Canvas &texture, bool upsideDown,
+                 Rectangle source, Rectangle dest, Color tint) {
+  // a negative size flips the image that way.
+  bool flipX = source.width < 0, flipY = source.height < 0;
+  source.width = std::abs(source.width);
+  source.height = std::abs(source.height);
+  if (upsideDown) {
+    flipY = !flipY;
+    source.y = texture.height - source.y - source.height;
+  }
+  auto span = cover(canvas, dest);
+  if (span.x1 <= span.x0 || span.y1 <= span.y0 || texture.width == 0 ||
+      texture.height == 0) {
+    return;
+  }
+
+  // which texel every column of the span comes from.
+  static thread_local std::vector<int> columns;
+  static thread_local std::vector<uint32_t> row;
+  columns.resize(span.x1 - span.x0);
+  row.resize(span.x1 - span.x0);
+  for (int x = span.x0; x < span.x1; ++x) {
+    float u = (x + 0.5f - dest.x) / dest.width;
+    if (flipX) {
+      u = 1 - u;
+    }
+    columns[x - span.x0] = std::clamp(
+        (int)std::floor(source.x + u * source.width), 0, texture.width - 1);
+  }
+
+  const bool tinted = pack(tint) != pack(WHITE);
+  for (int y = span.y0; y < span.y1; ++y) {
+    float v = (y + 0.5f - dest.y) / dest.height;
+    if (flipY) {
+      v = 1 - v;
+    }
+    int ty = std::clamp((int)std::floor(source.y + v * source.height), 0,
+                        texture.height - 1);
+    const auto *texels = texture.row(ty);
+    for (size_t i = 0; i < columns.size(); ++i) {
+      row[i] = texels[columns[i]];
+    }
+    if (tinted) {
+      for (auto &pixel : row) {
+        auto color = unpack(pixel);
+        color.r = div255(color.r * tint.r);
+        color.g = div255(color.g * tint.g);
+        color.b = div255(color.b * tint.b);
+        color.a = div255(color.a * tint.a);
+        pixel = pack(color);
+      }
+    }
+    blendSpan(canvas.row(y) + span.x0, row.data(), row.size());
+  }
+}
+
+// laid out like raylib's DrawText: glyphs scaled up from 10 pixels, a pixel
+// of spacing per 10, and new lines 12 pixels per 10 apart.
+void drawText(Canvas &canvas, const char *text, float x, float y,
+              float fontSize, Color color) {
+  fontSize = std::max(fontSize, (float)fontBaseSize);
+  const float scale = fontSize / fontBaseSize;
+  const float spacing = std::floor(fontSize / fontBaseSize);
+  float penX = x, penY = y;
+  for (; *text; ++text) {
+    if (*text == '\n') {
+      penX = x;
+      penY += (fontBaseSize + 2) * scale;
+      continue;
+    }
+    int index = (unsigned char)*text - ' ';
+    if (index >= 0 && index < 95) {
+      for (int gy = 0; gy < 7; ++gy) {
+        for (int gx = 0; gx < 5; ++gx) {
+          if ((glyphs[index][gy] >> gx) & 1) {
+            fillRect(canvas,
+                     {penX + gx * scale, penY + (gy + 1) * scale, scale,
+                      scale},
+                     color);
+          }
+        }
+      }
+    }
+    penX += 5 * scale + spacing;
+  }
+}
+
+} // namespace
+
+void SoftwareBackend::addTexture(Texture2D texture, ::Image image) {
+  auto &pixels = textures[texture.id];
+  pixels.resize(image.width, image.height);
+  auto *colors = LoadImageColors(image);
+  if (colors) {
+    std::memcpy(pixels.pixels.data(), colors,
+                pixels.pixels.size() * sizeof(uint32_t));
+    UnloadImageColors(colors);
+  }
+}
+
+void SoftwareBackend::present(const DrawList &list) {
+  bool resized = canvas.width != list.width || canvas.height != list.height;
+  if (resized) {
+    canvas.resize(list.width, list.height);
+  }
+  skipped = !resized && list == previous;
+  if (skipped) {
+    framesSkipped++;
+    return;
+  }
+
+  // layers first, inner ones end first so they're ready for the ones around
+  // them.
+  for (uint32_t i = 0; i < list.commands.size(); ++i) {
+    const auto &command = list.commands[i];
+    if (command.kind == DrawCommand::Kind::EndLayer) {
+      const auto &target = list.targets[list.commands[command.index].index];
+      auto &layer = targets[target.texture.id];
+      if (layer.width != target.texture.width ||
+          layer.height != target.texture.height) {
+        layer.resize(target.texture.width, target.texture.height);
+      }
+      submit(layer, list, command.index + 1, i);
+    }
+  }
+  std::fill(canvas.pixels.begin(), canvas.pixels.end(), 0);
+  submit(canvas, list, 0, list.commands.size());
+  previous = list;
+}
+
+void SoftwareBackend::submit(Canvas &canvas, const DrawList &list,
+                             uint32_t from, uint32_t to) {
+  for (uint32_t i = from; i < to; ++i) {
+    const auto &command = list.commands[i];
+    const auto &dest = command.dest;
+    switch (command.kind) {
+    case DrawCommand::Kind::Clear:
+      std::fill(canvas.pixels.begin(), canvas.pixels.end(),
+                pack(command.color));
+      break;
+    case DrawCommand::Kind::Rect:
+      fillRect(canvas, dest, command.color);
+      break;
+    case DrawCommand::Kind::RectLines:
+      strokeRect(canvas, dest, command.value, command.color);
+      break;
+    case DrawCommand::Kind::Circle:
+      fillCircle(canvas, dest.x, dest.y, dest.width, command.color);
+      break;
+    case DrawCommand::Kind::Texture: {
+      Rectangle at = {dest.x - command.origin.x, dest.y - command.origin.y,
+                      dest.width, dest.height};
+      if (auto target = targets.find(command.texture.id);
+          target != targets.end()) {
+        drawTexture(canvas, target->second, true, command.source, at,
+                    command.color);
+      } else if (auto texture = textures.find(command.texture.id);
+                 texture != textures.end()) {
+        drawTexture(canvas, texture->second, false, command.source, at,
+                    command.color);
+      } else {
+        fillRect(canvas, at, command.color);
+      }
+      break;
+    }
+    case DrawCommand::Kind::Text:
+      drawText(canvas, list.strings.data() + command.index, dest.x, dest.y,
+               command.value, command.color);
+      break;
+    case DrawCommand::Kind::Rects:
+      for (auto j = command.index; j < command.end; ++j) {
+        fillRect(canvas, list.batchRects[j].rect, list.batchRects[j].color);
+      }
+      break;
+    case DrawCommand::Kind::BeginLayer:
+      i = command.end;
+      break;
+    case DrawCommand::Kind::EndLayer:
+      break;
+    }
+  }
+}
+
+bool SoftwareBackend::exportPng(const char *path) const {
+  // a window shows the frame without it's alpha, so the png does too.
+  std::vector<uint32_t> opaque(canvas.pixels);
+  for (auto &pixel : opaque) {
+    pixel |= pack({0, 0, 0, 255});
+  }
+  ::Image image = {opaque.data(), canvas.width, canvas.height, 1,
+                   PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  return ExportImage(image, path);
+}
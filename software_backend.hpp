@@ -0,0 +1,60 @@
+#pragma once
+#include "rayui.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace rayui {
+
+// a block of pixels in memory: RGBA bytes in that order, top row first.
+struct Canvas {
+  int width = 0, height = 0;
+  std::vector<uint32_t> pixels;
+
+  void resize(int width, int height) {
+    this->width = width;
+    this->height = height;
+    pixels.resize(size_t(width) * height);
+  }
+  uint32_t *row(int y) { return pixels.data() + size_t(y) * width; }
+  const uint32_t *row(int y) const {
+    return pixels.data() + size_t(y) * width;
+  }
+};
+
+// puts a `DrawList` into a `Canvas` on the cpu, so frames can be drawn, timed
+// and saved on machines with no gpu or display.
+// - textures are drawn from images handed over with `addTexture`. ones it
+//   doesn't know are filled with their tint.
+// - raylib's font only exists once there's a window, so text is drawn with a
+//   built in 5x7 font. it's laid out like raylib's, but isn't pixel for pixel
+//   the same.
+// - rotated textures are drawn unrotated.
+class SoftwareBackend {
+public:
+  // draw `texture` from the pixels of `image`.
+  void addTexture(Texture2D texture, ::Image image);
+
+  // whether the last frame presented was the same as the one before it, and
+  // so wasn't drawn again.
+  bool skipped = false;
+  size_t framesSkipped = 0;
+
+  void present(const DrawList &list);
+  const Canvas &frame() const { return canvas; }
+  // writes the last frame presented to a png.
+  bool exportPng(const char *path) const;
+
+private:
+  Canvas canvas;
+  std::unordered_map<unsigned, Canvas> textures;
+  // what was drawn into each layer's render texture, by the id of it's
+  // texture. they're read upside down, the way a gpu's render textures are.
+  std::unordered_map<unsigned, Canvas> targets;
+  DrawList previous;
+
+  void submit(Canvas &canvas, const DrawList &list, uint32_t from,
+              uint32_t to);
+};
+
+} // namespace rayui
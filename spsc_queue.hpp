@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace boom_tetris {
+
+// a fixed size queue for one thread to push into and one other thread to pop
+// from, with no locks. it never allocates, a push into a full queue just
+// fails.
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "the capacity has to be a power of two");
+
+public:
+  bool push(const T &value) {
+    auto tail = this->tail.load(std::memory_order_relaxed);
+    if (tail - head.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    slots[tail % Capacity] = value;
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> pop() {
+    auto head = this->head.load(std::memory_order_relaxed);
+    if (head == tail.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    T value = slots[head % Capacity];
+    this->head.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  std::array<T, Capacity> slots = {};
+  // each end on a cache line of it's own, so the two threads aren't fighting
+  // over one.
+  alignas(64) std::atomic<size_t> head = 0;
+  alignas(64) std::atomic<size_t> tail = 0;
+};
+
+} // namespace boom_tetris
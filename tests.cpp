@@ -0,0 +1,232 @@
+// checks of the game's logic that don't need a window, run by ctest. prints
+// every check that fails, and exits with 1 if any did.
+//
+// usage: boom_tetris_tests [--filter text]
+
+#include "bot.hpp"
+#include "garbage.hpp"
+#include "simulation.hpp"
+#include "tetris.hpp"
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace boom_tetris;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      printf("  %s:%d: %s\n", __FILE__, __LINE__, #condition);                 \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+// a board with a spawn buffer: everything works on all of it, hidden or not.
+static void hiddenRowsBoard() {
+  using Board = boom_tetris::Board<10, 22, 2>;
+  static_assert(Board::visibleHeight == 20);
+  Board board;
+  for (int x = 0; x < board.width; ++x) {
+    board.fill(x, board.height - 1, 1);
+  }
+  board.fill(3, 0, 2);
+  CHECK(board.full(board.height - 1));
+  CHECK(clearFullRows(board) == 1);
+  CHECK(!board.empty(3, 1));
+  CHECK(board.rows[board.height - 1] == 0);
+
+  // a piece in the hidden rows still fits and lands on the stack.
+  CHECK(fits(board, Shape::I, Orientation::Up, {5, 0}));
+  CHECK(bestPlacement(board, Shape::O).has_value());
+
+  // the cell in the top row goes out the top.
+  CHECK(board.raiseRow(Board::fullRow, 0));
+  CHECK(!board.raiseRow(Board::fullRow, 0));
+}
+
+// a board wider than 32 columns keeps it's rows in 64 bit words, and nothing
+// on the way through may cut them down to 32.
+static void wideBoard() {
+  using Board = boom_tetris::Board<48, 4>;
+  static_assert(std::is_same_v<Board::Row, uint64_t>);
+  Board board;
+  // one block high up in column 40, with three holes under it.
+  board.fill(40, 0, 0);
+  float expected = -0.510066f * 4 - 0.35663f * 3 - 0.184483f * 8;
+  CHECK(std::abs(evaluateBoard(board, 0) - expected) < 1e-4f);
+  CHECK(columnTops(board)[40] == 0);
+  CHECK(findLongBarDependencies(board) == 0);
+
+  for (int x = 0; x < board.width; ++x) {
+    board.fill(x, board.height - 1, 0);
+  }
+  CHECK(board.full(board.height - 1));
+  board.clear(47, board.height - 1);
+  CHECK(!board.full(board.height - 1));
+
+  GarbageGenerator<Board> garbage(3);
+  for (auto row : garbage.generate(2)) {
+    CHECK((row & ~Board::fullRow) == 0);
+    CHECK(row != Board::fullRow);
+  }
+}
+
+// garbage that pushes the stack out of the top ends the game, instead of the
+// blocks quietly going missing.
+static void garbageToppingOut() {
+  auto assets = std::make_shared<Assets>();
+  Game game(assets);
+  game.silent = true;
+  game.mode = Game::Mode::Dig;
+  game.reset();
+  game.scene = Game::Scene::InGame;
+  game.board.fill(0, 0, 1);
+  game.pendingGarbage = 1;
+  game.processGameLogic({});
+  CHECK(game.scene == Game::Scene::GameOver);
+
+  // with room at the top, it comes in and play carries on.
+  game.reset();
+  game.scene = Game::Scene::InGame;
+  game.pendingGarbage = 2;
+  game.processGameLogic({});
+  CHECK(game.scene == Game::Scene::InGame);
+  CHECK(game.garbageRows == Game::digStartRows + 2);
+}
+
+// the game deals pieces into the top of the visible board.
+static void spawn() {
+  auto assets = std::make_shared<Assets>();
+  Game game(assets);
+  game.silent = true;
+  game.reset();
+  game.scene = Game::Scene::InGame;
+  game.processGameLogic({});
+  CHECK(game.tetromino.has_value());
+  CHECK(game.tetromino->position.x == GameBoard::width / 2);
+  CHECK(game.tetromino->position.y == GameBoard::hiddenRows);
+}
+
+// a 40 lines game finished on the simulation's thread: the time has to make
+// it back to the game that's shown, even though the game over screen stops
+// the thread straight away.
+static void simulatedPersonalBest() {
+  auto assets = std::make_shared<Assets>();
+  Game shown(assets);
+  shown.silent = true;
+  shown.mode = Game::Mode::FortyLines;
+  shown.reset();
+  shown.scene = Game::Scene::InGame;
+  shown.totalLinesCleared = 39;
+  // the bottom row is full but for where the first piece lands, dropped
+  // straight down.
+  const auto &pattern = shapePatterns[(int)shown.nextShape];
+  int lowest = 0;
+  for (const auto &block : pattern) {
+    lowest = std::max(lowest, block.pos.y);
+  }
+  auto gaps = GameBoard::Row(0);
+  for (const auto &block : pattern) {
+    if (block.pos.y == lowest) {
+      gaps |= GameBoard::Row(1) << (GameBoard::width / 2 + block.pos.x);
+    }
+  }
+  for (int x = 0; x < GameBoard::width; ++x) {
+    if (!(gaps >> x & 1)) {
+      shown.board.fill(x, GameBoard::height - 1, 0);
+    }
+  }
+
+  Simulation simulation(assets);
+  InputFrame down;
+  down.press(Action::Down);
+  auto started = Simulation::Clock::now();
+  while (shown.scene == Game::Scene::InGame &&
+         Simulation::Clock::now() - started < std::chrono::seconds(10)) {
+    simulation.setInput(down, Simulation::Clock::now());
+    simulation.present(shown);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  // the frame that shows the game over has the scores already, and the game
+  // over screen stopping the thread on the next one doesn't lose them.
+  CHECK(shown.scoreFile.fortyLinesPb.count() > 0);
+  simulation.stop();
+  CHECK(shown.scene == Game::Scene::GameOver);
+  CHECK(shown.totalLinesCleared == 40);
+  CHECK(shown.scoreFile.fortyLinesPb.count() > 0);
+  CHECK(shown.scoreFile.fortyLinesPb == shown.elapsed);
+}
+
+// every effect the game plays has to fit a slot of the pool, whatever the
+// build, or it comes off the heap. past the pool's slots, they still play.
+static void effectsFitThePool() {
+  auto assets = std::make_shared<Assets>();
+  Game game(assets);
+  game.silent = true;
+  game.reset();
+  auto drawAll = [&] {
+    int frames = 0;
+    while (!game.effectPlayer.empty() && frames++ < 600) {
+      rayui::drawList().reset(800, 600);
+      game.effectPlayer.draw(
+          {1 / 60.0f, &rayui::drawList(), {0, 0}, {32, 32}});
+    }
+  };
+
+  // a tetris dissolving, the biggest the line clear effect gets.
+  Game::Cue tetris = {.kind = Game::Cue::Kind::Lines, .lineCount = 4,
+                      .dissolve = true};
+  for (int i = 0; i < 4; ++i) {
+    tetris.lines[i] = GameBoard::height - 1 - i;
+  }
+  auto before = Effect::unpooled();
+  game.play(tetris);
+  CHECK(!game.effectPlayer.empty());
+  drawAll();
+  CHECK(Effect::unpooled() == before);
+
+  for (size_t i = 0; i < Effect::poolSlots + 8; ++i) {
+    game.play(tetris);
+  }
+  CHECK(Effect::unpooled() == before + 8);
+  drawAll();
+  CHECK(game.effectPlayer.empty());
+}
+
+int main(int argc, char *argv[]) {
+  std::string filter = argc > 2 && std::string(argv[1]) == "--filter"
+                           ? argv[2]
+                           : "";
+  const std::vector<std::pair<const char *, std::function<void()>>> tests = {
+      {"hidden rows board", hiddenRowsBoard},
+      {"wide board", wideBoard},
+      {"garbage topping out", garbageToppingOut},
+      {"spawn", spawn},
+      {"simulated personal best", simulatedPersonalBest},
+      {"effects fit the pool", effectsFitThePool},
+  };
+
+  // no window: the assets keep their atlas on the cpu, and nothing's heard.
+  SetTraceLogLevel(LOG_WARNING);
+  for (const auto &[name, test] : tests) {
+    if (!filter.empty() && std::string(name).find(filter) == std::string::npos) {
+      continue;
+    }
+    int before = failures;
+    printf("%s\n", name);
+    test();
+    if (failures > before) {
+      printf("  FAILED\n");
+    }
+  }
+  if (failures) {
+    printf("%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all passed\n");
+  return 0;
+}
@@ -1,11 +1,14 @@
 #include "tetris.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
 #include "rayui.hpp"
+#include <bit>
 #include <chrono>
 #include <cmath>
 #include <functional>
-#include <iostream>
 #include <memory>
 #include <random>
+#include <span>
 #include <raylib.h>
 #include <stdexcept>
 #include <string>
@@ -14,20 +17,24 @@ using namespace boom_tetris;
 
 void Game::saveTetromino() { tetromino->saveState(); }
 
-std::unordered_map<Shape, std::vector<Block>> Game::shapePatterns = {
-    {Shape::L, {{{-1, 1}, 1}, {{-1, 0}, 1}, {{0, 0}, 1}, {{1, 0}, 1}}},
-    {Shape::J, {{{-1, 0}, 0}, {{0, 0}, 0}, {{1, 0}, 0}, {{1, 1}, 0}}},
-    {Shape::Z, {{{-1, 0}, 1}, {{0, 0}, 1}, {{0, 1}, 1}, {{1, 1}, 1}}},
-    {Shape::S, {{{-1, 1}, 0}, {{0, 1}, 0}, {{0, 0}, 0}, {{1, 0}, 0}}},
-    {Shape::I, {{{-1, 0}, 3}, {{0, 0}, 3}, {{1, 0}, 3}, {{2, 0}, 3}}},
-    {Shape::T, {{{-1, 0}, 3}, {{0, 0}, 3}, {{1, 0}, 3}, {{0, 1}, 3}}},
-    {Shape::O, {{{0, 0}, 2}, {{0, 1}, 2}, {{1, 0}, 2}, {{1, 1}, 2}}},
-};
+Assets::Assets() {
+  unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
 
-Game::Game() {
-  board = Board();
-  setNextShape();
-  blockTexture = LoadTexture("res/block2.png");
+  auto blocks = atlas.load("res/block2.png");
+  auto title = atlas.load("res/title.png");
+  atlas.build();
+  titleSource = atlas.source(title);
+  const auto origin = atlas.source(blocks);
+  for (int palette = 0; palette < palettes; ++palette) {
+    for (int image = 0; image < blockImages; ++image) {
+      blockSources[palette][image] = {origin.x + image * 8,
+                                      origin.y + palette * 8, 8, 8};
+      blockColors[palette][image] =
+          GetImageColor(atlas.image, origin.x + image * 8 + 4,
+                        origin.y + palette * 8 + 4);
+    }
+  }
+  auto loading = Tracer::Clock::now();
   shiftSound = LoadSound("res/shift.wav");
   rotateSound = LoadSound("res/rotate.wav");
   lockInSound = LoadSound("res/lock.wav");
@@ -62,11 +69,29 @@ Game::Game() {
   };
   
   
-  unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    
+  tracer().complete("load sounds", loading, Tracer::Clock::now());
+
   std::shuffle(dependencySounds.begin(), dependencySounds.end(), std::default_random_engine(seed));
   std::shuffle(tetrisSounds.begin(), tetrisSounds.end(), std::default_random_engine(seed));
   std::shuffle(bagelSounds.begin(), bagelSounds.end(), std::default_random_engine(seed));
+}
+
+Game::Game(std::shared_ptr<Assets> assets) : assets(std::move(assets)) {
+  unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+
+  if (!this->assets) {
+    this->assets = std::make_shared<Assets>();
+  }
+
+  board = GameBoard();
+  reseed(seed);
+  setNextShape();
+
+  // the particles have an rng of their own, they mustn't change what the game
+  // deals.
+  particles.rng = Rng(seed);
+  particles.gravity = 30;
+  particles.bottom = GameBoard::visibleHeight;
   
   gameGrid = createGrid();
   scene = Scene::MainMenu;
@@ -75,49 +100,87 @@ Game::Game() {
   generateGravityLevels(255);
 }
 
-void Game::processGameLogic() {
-  
-  
-  
-  elapsed += std::chrono::duration_cast<std::chrono::milliseconds>(
-                 std::chrono::seconds(1)) /
-             60;
+void Game::reseed(uint64_t seed) {
+  randomizer = GameRandomizer(seed);
+  garbage = GarbageGenerator<GameBoard>(Rng(seed).next());
+}
 
+void Game::processGameLogic(InputFrame input) {
+  Profiler::Scope scope(Phase::Logic);
+  pieceBefore = tetromino;
   frameCount++;
+  // worked out from the tick count, adding up a tick's rounded milliseconds
+  // would drift.
+  elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::duration<double>(frameCount / tickRate));
+  if (mode == Mode::Dig && frameCount % digRiseFrames == 0) {
+    pendingGarbage++;
+  }
+
   // if an animation is active, we pause the game.
+  if (animation_queue.empty()) {
+    updateTetromino(input);
+  }
+
+  // animations play out after the logic, holding it up until they're done.
   if (!animation_queue.empty()) {
-    return;
+    Profiler::Scope scope(Phase::Animation);
+    if (animation_queue.front()->invoke()) {
+      if (traced) {
+        auto &done = *animation_queue.front();
+        tracer().end(done.name(), (uint64_t)&done);
+      }
+      animation_queue.pop_front();
+    }
   }
 
+  previousInput = input;
+}
+
+void Game::updateTetromino(InputFrame input) {
   if (!tetromino) {
+    // garbage only comes in between pieces, so it never shoves one in play.
+    if (pendingGarbage > 0) {
+      if (traced) {
+        tracer().instant("garbage", "rows", pendingGarbage);
+      }
+      bool fits = insertGarbage(pendingGarbage);
+      pendingGarbage = 0;
+      // a stack pushed out of the top is topped out, same as a piece that
+      // can't spawn.
+      if (!fits) {
+        topOut();
+        return;
+      }
+    }
+
     // spawn a new tetromino, cause the last one landed.
     auto shape = nextShape;
     tetromino = Tetromino(shape);
+    // pieces come in at the top of the visible board, in the middle.
+    tetromino->position = {board.width / 2, board.hiddenRows};
+    pieceCount++;
     setNextShape();
+    if (traced) {
+      tracer().instant("spawn", "shape", (int64_t)shape);
+    }
 
     tetromino->saveState();
 
     // game-over condition. currently, this is premature sometimes.
     if (resolveCollision(tetromino)) {
-      if (score > scoreFile.high_score) {
-        scoreFile.high_score = score;
-      }
-      scene = Scene::GameOver;
+      topOut();
       return;
     }
   }
 
-  if (downLocked && IsKeyPressed(KEY_DOWN)) {
+  if (downLocked && input.pressed(Action::Down, previousInput)) {
     downLocked = false;
   }
 
-  // used to increment until >= 1 so we can have sub-frame velocity for the
-  // tetromino.
-  static float budge = 0.0;
-
   cleanTetromino(tetromino);
 
-  auto horizontal = delayedAutoShift();
+  auto horizontal = delayedAutoShift(input);
 
   auto executeMovement = [&](std::function<void()> fun) -> bool {
     tetromino->saveState();
@@ -125,43 +188,31 @@ void Game::processGameLogic() {
     return resolveCollision(tetromino);
   };
 
-  bool turnLeft = IsKeyPressed(KEY_Z);
-  bool turnRight = IsKeyPressed(KEY_X) || IsKeyPressed(KEY_UP);
-
-  bool moveDown = IsKeyDown(KEY_DOWN) && !downLocked;
+  bool turnLeft = input.pressed(Action::RotateLeft, previousInput);
+  bool turnRight = input.pressed(Action::RotateRight, previousInput);
 
-  if (auto gpad = findGamepad(); gpad != -1) {
-    // z or A (xbox controller)
-    turnLeft = turnLeft ||
-               IsGamepadButtonPressed(gpad, GAMEPAD_BUTTON_RIGHT_FACE_DOWN);
-    // x or B (xbox controller)
-    turnRight = turnRight ||
-                IsGamepadButtonPressed(gpad, GAMEPAD_BUTTON_RIGHT_FACE_RIGHT);
-    // down arrow or dpad down
-    moveDown =
-        moveDown || IsGamepadButtonPressed(gpad, GAMEPAD_BUTTON_LEFT_FACE_DOWN);
-  }
+  bool moveDown = input.down(Action::Down) && !downLocked;
 
   if (turnLeft) {
     if (!executeMovement([&]() { tetromino->spinLeft(); })) {
-      PlaySound(rotateSound);
+      playSound(assets->rotateSound);
     }
   }
 
   if (turnRight) {
     if (!executeMovement([&] { tetromino->spinRight(); })) {
-      PlaySound(rotateSound);
+      playSound(assets->rotateSound);
     }
   }
 
   if (horizontal.left) {
     if (!executeMovement([&] { tetromino->position.x--; })) {
-      PlaySound(shiftSound);
+      playSound(assets->shiftSound);
     }
   }
   if (horizontal.right) {
     if (!executeMovement([&] { tetromino->position.x++; })) {
-      PlaySound(shiftSound);
+      playSound(assets->shiftSound);
     }
   }
 
@@ -192,28 +243,43 @@ void Game::processGameLogic() {
 
   for (const auto &block : getTransformedBlocks(tetromino)) {
     auto pos = block.pos;
-    if (pos.x < 0 || pos.x >= boardWidth || pos.y < 0 || pos.y >= boardHeight) {
+    if (!board.inBounds(pos.x, pos.y)) {
       continue;
     }
-    auto &cell = board.get_cell(pos.x, pos.y);
-    cell.empty = false;
-    cell.imageIdx = block.imageIdx;
+    board.fill(pos.x, pos.y, block.imageIdx);
   }
 
   // if we landed, we leave the cells where they are and spawn a new piece.
   // also check for line clears and tetrises.
   if (landed) {
-    animation_queue.push_back(
-        std::make_unique<LockInAnimation>(this, tetromino->position.y));
+    if (traced) {
+      tracer().instant("lock", "row", tetromino->position.y);
+    }
+    if (!turbo) {
+      startAnimation(
+          std::make_unique<LockInAnimation>(this, tetromino->position.y));
+    }
     auto linesToClear = checkLines();
     if (linesToClear.size() > 0) {
-      ::PlaySound(clearLineSound);
-      animation_queue.push_back(std::make_unique<CellDissolveAnimation>(
-          this, linesToClear, tetromino->softDropHeight));
+      if (traced) {
+        tracer().instant("lines", "count", (int64_t)linesToClear.size());
+      }
+      playSound(assets->clearLineSound);
+      celebrateLines(linesToClear, turbo);
+      if (turbo) {
+        // the rows go now, the dissolve is only drawn.
+        collapseLines(linesToClear);
+      } else {
+        startAnimation(std::make_unique<CellDissolveAnimation>(
+            this, linesToClear, tetromino->softDropHeight));
+      }
     } else {
-      ::PlaySound(lockInSound);
+      playSound(assets->lockInSound);
       applySoftDropScore(tetromino->softDropHeight);
     }
+    if (turbo) {
+      checkDependencies();
+    }
     tetromino.reset();
 
     downLocked = true;
@@ -222,87 +288,115 @@ void Game::processGameLogic() {
   gravity = oldGravity;
 }
 
-void Game::setNextShape() {
-  static int num_shapes = (int)Shape::O + 1;
-  auto shape = Shape(rand() % num_shapes);
-  nextShape = shape;
+void Game::setNextShape() { nextShape = randomizer.next(); }
+
+void Game::startAnimation(std::unique_ptr<Animation> animation) {
+  if (traced) {
+    tracer().begin(animation->name(), (uint64_t)animation.get());
+  }
+  animation_queue.push_back(std::move(animation));
+}
+
+bool Game::insertGarbage(int count) {
+  // what's already down there has to stay diggable along with the new rows.
+  auto existing = std::span<const GameBoard::Row>(board.rows).last(garbageRows);
+  bool fits = true;
+  for (auto row : garbage.generate(count, existing)) {
+    fits &= board.raiseRow(row, garbage.rng.below(3));
+  }
+  garbageRows = std::min(garbageRows + count, board.height);
+  return fits;
+}
+
+void Game::topOut() {
+  if (score > scoreFile.high_score) {
+    scoreFile.high_score = score;
+  }
+  scene = Scene::GameOver;
+  if (traced) {
+    tracer().instant("game over", "score", (int64_t)score);
+  }
+  shatterBoard();
 }
 
 void Game::cleanTetromino(std::optional<Tetromino> &tetromino) {
   auto indices = getTransformedBlocks(tetromino);
   for (const auto &block : indices) {
     auto pos = block.pos;
-    if (pos.y < 0 || pos.y >= boardHeight || pos.x < 0 || pos.x >= boardWidth) {
+    if (!board.inBounds(pos.x, pos.y)) {
       continue;
     }
-    auto &cell = board.get_cell(pos.x, pos.y);
-    cell.empty = true;
+    board.clear(pos.x, pos.y);
   }
 }
 
 std::vector<size_t> Game::checkLines() {
   std::vector<size_t> linesToBurn = {};
-  size_t i = 0;
-  for (const auto &row : board.rows) {
-    bool full = true;
-    for (const auto &cell : row) {
-      if (cell.empty) {
-        full = false;
-        break;
-      }
+  for (int y = 0; y < board.height; ++y) {
+    if (board.full(y)) {
+      linesToBurn.push_back(y);
     }
-    if (full) {
-      linesToBurn.push_back(i);
-    }
-    ++i;
   }
 
   return linesToBurn;
 }
 
 Grid Game::createGrid() {
-  Grid grid({26, 20});
-  grid.style.background = BG_COLOR;
+  uiArena.reset();
+  Grid grid(uiArena, {26, 20});
+
+  // everything that isn't the board, the next piece or a button only changes
+  // when a number on it does, so it's kept drawn in a texture.
+  auto hud = grid.emplace_element<Layer>(Position{0, 0}, Size{26, 20});
+  hud->subdivisions = {26, 20};
+  // BG_COLOR is see-through, this is what it comes out as on screen.
+  hud->style.background = GetColor(0x121212ff);
 
-  auto linesLabel = grid.emplace_element<Label>(Position{1, 1}, Size{7, 1});
+  auto linesLabel = hud->emplace_element<Label>(Position{1, 1}, Size{7, 1});
   linesLabel->text = "Lines:";
-  grid.emplace_element<NumberText>(Position{1, 2}, Size{7, 1},
+  hud->emplace_element<NumberText>(Position{1, 2}, Size{7, 1},
                                    &totalLinesCleared, WHITE);
 
-  if (mode == Mode::FortyLines) {
-    auto timer_label = grid.emplace_element<Label>(Position{1, 4}, Size{5, 1});
-    timer_label->text = "Timer";
-    auto timer_text = grid.emplace_element<TimeText>(Position{1, 5}, Size{1, 1},
-                                                     &elapsed, WHITE);
-  }
+  // the modes' extras share a spot, only one lot's ever shown.
+  auto timer_label = hud->emplace_element<Label>(Position{1, 4}, Size{5, 1});
+  timer_label->text = "Timer";
+  auto timer_text = hud->emplace_element<TimeText>(Position{1, 5}, Size{1, 1},
+                                                   &elapsed, WHITE);
+  fortyLinesElements = {timer_label, timer_text};
+
+  auto dugLabel = hud->emplace_element<Label>(Position{1, 4}, Size{5, 1});
+  dugLabel->text = "Dug:";
+  auto dugText = hud->emplace_element<NumberText>(Position{1, 5}, Size{7, 1},
+                                                  &garbageCleared, WHITE);
+  digElements = {dugLabel, dugText};
+  showModeElements();
   
-  auto playfield = createBoardGrid();
-  playfield->position = {8, 0};
-  playfield->size = {10, 20};
-  grid.elements.push_back(playfield);
+  auto playfield = grid.emplace_element<BoardView<GameBoard>>(
+      Position{8, 0}, Size{10, 20}, *this, board);
+  playfield->style.background = BLACK;
 
   int yPos = 1, height = 1;
 
   auto topLabel =
-      grid.emplace_element<Label>(Position{19, yPos}, Size{7, height});
+      hud->emplace_element<Label>(Position{19, yPos}, Size{7, height});
   yPos += height;
   topLabel->text = "Top:";
-  grid.emplace_element<NumberText>(Position{19, yPos}, Size{7, height},
+  hud->emplace_element<NumberText>(Position{19, yPos}, Size{7, height},
                                    &scoreFile.high_score, WHITE);
   yPos += height;
   yPos += 1;
   
   auto scoreLabel =
-      grid.emplace_element<Label>(Position{19, yPos}, Size{7, height});
+      hud->emplace_element<Label>(Position{19, yPos}, Size{7, height});
   yPos += height;
   scoreLabel->text = "Score:";
-  grid.emplace_element<NumberText>(Position{19, yPos}, Size{7, height}, &score,
+  hud->emplace_element<NumberText>(Position{19, yPos}, Size{7, height}, &score,
                                    WHITE);
   yPos += height;
   yPos += 1;
 
   auto nextPieceLabel =
-      grid.emplace_element<Label>(Position{19, yPos}, Size{7, height});
+      hud->emplace_element<Label>(Position{19, yPos}, Size{7, height});
   yPos += height;
   nextPieceLabel->text = "Next:";
   height = 4;
@@ -314,10 +408,10 @@ Grid Game::createGrid() {
 
   height = 1;
   auto levelLabel =
-      grid.emplace_element<Label>(Position{19, yPos}, Size{7, height});
+      hud->emplace_element<Label>(Position{19, yPos}, Size{7, height});
   yPos += height;
   levelLabel->text = "Level:";
-  grid.emplace_element<NumberText>(Position{19, yPos}, Size{7, height}, &level,
+  hud->emplace_element<NumberText>(Position{19, yPos}, Size{7, height}, &level,
                                    WHITE);
   yPos += height;
   yPos += 1;
@@ -329,25 +423,31 @@ Grid Game::createGrid() {
   mainMenuButton->fontSize = 24;
   yPos += height;
 
-// somehow this causes a crash (pressing the reset button, not making it) and
-// windows is impossible to debug so I can't even breakpoint or find where it
-// happens. Somewhere in a windows api. pressing main menu and re-entering is
-// easy enough.
-#ifndef _WIN32
+  // resetting used to make the screen again, throwing away this button while
+  // it was being pressed, which crashed on windows. now nothing's thrown away.
   auto resetButton = grid.emplace_element<Button>(
       Position{19, yPos}, Size{5, height}, "Reset",
-      std::function<void()>([&]() { reset(); }), Style{BLACK, WHITE, BLACK, 3});
+      std::function<void()>([&]() { resetQueued = true; }),
+      Style{BLACK, WHITE, BLACK, 3});
   resetButton->fontSize = 24;
   yPos += height;
-#endif
 
   return grid;
 }
 
+void Game::showModeElements() {
+  for (auto element : fortyLinesElements) {
+    element->setHidden(mode != Mode::FortyLines);
+  }
+  for (auto element : digElements) {
+    element->setHidden(mode != Mode::Dig);
+  }
+}
+
 bool Game::resolveCollision(std::optional<Tetromino> &tetromino) {
   for (const auto block : getTransformedBlocks(tetromino)) {
     auto pos = block.pos;
-    if (pos.y >= boardHeight || pos.x < 0 || pos.x >= boardWidth ||
+    if (pos.y >= board.height || pos.x < 0 || pos.x >= board.width ||
         board.collides(pos)) {
       tetromino->position = tetromino->prev_position;
       tetromino->orientation = tetromino->prev_orientation;
@@ -357,24 +457,19 @@ bool Game::resolveCollision(std::optional<Tetromino> &tetromino) {
   return false;
 }
 
-bool Board::collides(Vec2 pos) noexcept {
-  int x = pos.x;
-  int y = pos.y;
-  return y < (int)rows.size() && y >= 0 && x < (int)rows[y].size() && x >= 0 &&
-         !get_cell(x, y).empty;
-}
-
-Game::~Game() {
-  UnloadTexture(blockTexture);
-  delete volumeLabel;
-}
+Game::~Game() { delete volumeLabel; }
 
 void Game::reset() {
-  gameGrid = createGrid();
+  showModeElements();
   downLocked = false;
   score = 0;
   animation_queue.clear();
   frameCount = 0;
+  pieceCount = 0;
+  budge = 0;
+  previousInput = {};
+  dasTimer = arrTimer = 0;
+  leftKeyPressed = rightKeyPressed = false;
   level = startLevel;
   gravity = gravityLevels[level];
   linesClearedThisLevel = 0;
@@ -382,44 +477,118 @@ void Game::reset() {
   board = {}; // reset the grid state.
   elapsed = {};
   tetromino = std::nullopt;
+  pieceBefore = std::nullopt;
+  garbageRows = 0;
+  pendingGarbage = 0;
+  garbageCleared = 0;
+  outgoingGarbage = 0;
+  particles.clear();
+  effectPlayer.clear();
+  cues.clear();
+  if (mode == Mode::Dig) {
+    insertGarbage(digStartRows);
+  }
   setNextShape();
 }
 
-HorizontalInput Game::delayedAutoShift() {
-  static float dasDelay = 0.26667f;
-  static float arrDelay = 0.070f;
-  static float dasTimer = 0.0f;
-  static float arrTimer = 0.0f;
-  static bool leftKeyPressed = false;
-  static bool rightKeyPressed = false;
-
-  bool moveLeft = false, moveRight = false;
+// copies everything `Snapshot` holds but the animations, between a game and a
+// snapshot in either direction, so the list of fields only lives here.
+template <typename From, typename To>
+static void copyState(const From &from, To &to) {
+  to.board = from.board;
+  to.tetromino = from.tetromino;
+  to.nextShape = from.nextShape;
+  to.randomizer = from.randomizer;
+  to.garbage = from.garbage;
+  to.garbageRows = from.garbageRows;
+  to.pendingGarbage = from.pendingGarbage;
+  to.outgoingGarbage = from.outgoingGarbage;
+  to.garbageCleared = from.garbageCleared;
+  to.previousInput = from.previousInput;
+  to.dasTimer = from.dasTimer;
+  to.arrTimer = from.arrTimer;
+  to.leftKeyPressed = from.leftKeyPressed;
+  to.rightKeyPressed = from.rightKeyPressed;
+  to.downLocked = from.downLocked;
+  to.budge = from.budge;
+  to.gravity = from.gravity;
+  to.playerGravity = from.playerGravity;
+  to.frameCount = from.frameCount;
+  to.pieceCount = from.pieceCount;
+  to.dependencies = from.dependencies;
+  to.level = from.level;
+  to.score = from.score;
+  to.linesClearedThisLevel = from.linesClearedThisLevel;
+  to.totalLinesCleared = from.totalLinesCleared;
+  to.elapsed = from.elapsed;
+  to.scene = from.scene;
+}
 
-  auto gamepad = findGamepad();
-  bool leftDown = IsKeyDown(KEY_LEFT);
-  bool rightDown = IsKeyDown(KEY_RIGHT);
+void Game::save(Snapshot &snapshot) const {
+  copyState(*this, snapshot);
+  snapshot.animations.clear();
+  for (const auto &animation : animation_queue) {
+    snapshot.animations.push_back(animation->clone());
+  }
+}
 
-  if (gamepad != -1) {
-    leftDown =
-        leftDown || IsGamepadButtonDown(gamepad, GAMEPAD_BUTTON_LEFT_FACE_LEFT);
-    rightDown = rightDown ||
-                IsGamepadButtonDown(gamepad, GAMEPAD_BUTTON_LEFT_FACE_RIGHT);
+void Game::load(const Snapshot &snapshot) {
+  copyState(snapshot, *this);
+  animation_queue.clear();
+  for (const auto &animation : snapshot.animations) {
+    animation_queue.push_back(animation->clone());
+    // the snapshot may have come from another game.
+    animation_queue.back()->game = this;
   }
+}
+
+uint64_t Game::checksum() const {
+  // fnv-1a over the parts of the state that everything else follows from.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto mix = [&](uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash = (hash ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3ull;
+    }
+  };
+  for (auto row : board.rows) {
+    mix(row);
+  }
+  if (tetromino) {
+    mix(((uint64_t)tetromino->position.x << 32) ^ tetromino->position.y);
+    mix((uint64_t)tetromino->orientation);
+  }
+  mix((uint64_t)nextShape);
+  mix(randomizer.rng.state);
+  mix(garbage.rng.state);
+  mix(pendingGarbage);
+  mix(pieceCount);
+  mix(score);
+  mix(totalLinesCleared);
+  mix(animation_queue.size());
+  mix((uint64_t)scene);
+  return hash;
+}
+
+HorizontalInput Game::delayedAutoShift(InputFrame input) {
+  bool moveLeft = false, moveRight = false;
+
+  bool leftDown = input.down(Action::Left);
+  bool rightDown = input.down(Action::Right);
 
   if (leftDown && !rightDown) {
     if (!leftKeyPressed) {
       leftKeyPressed = true;
-      dasTimer = dasDelay;
+      dasTimer = dasFrames;
       moveLeft = true;
     } else if (dasTimer <= 0) {
       if (arrTimer <= 0) {
         moveLeft = true;
-        arrTimer = arrDelay;
+        arrTimer = arrFrames;
       } else {
-        arrTimer -= GetFrameTime();
+        arrTimer--;
       }
     } else {
-      dasTimer -= GetFrameTime();
+      dasTimer--;
     }
   } else {
     leftKeyPressed = false;
@@ -428,42 +597,31 @@ HorizontalInput Game::delayedAutoShift() {
   if (rightDown && !leftDown) {
     if (!rightKeyPressed) {
       rightKeyPressed = true;
-      dasTimer = dasDelay;
+      dasTimer = dasFrames;
       moveRight = true;
     } else if (dasTimer <= 0) {
       if (arrTimer <= 0) {
-        arrTimer = arrDelay;
+        arrTimer = arrFrames;
         moveRight = true;
       } else {
-        arrTimer -= GetFrameTime();
+        arrTimer--;
       }
     } else {
-      dasTimer -= GetFrameTime();
+      dasTimer--;
     }
   } else {
     rightKeyPressed = false;
   }
-  if (!IsKeyDown(KEY_LEFT) && !IsKeyDown(KEY_RIGHT)) {
+  if (!leftDown && !rightDown) {
     arrTimer = 0;
   }
   return HorizontalInput(moveLeft, moveRight);
 }
 
-Cell &Board::operator[](int x, int y) {
-  if (rows.size() > y) {
-    auto &row = rows[y];
-    if (row.size() > x) {
-      return row[x];
-    }
-  }
-  throw std::runtime_error("board subscript out of range");
-}
-
 ShapeIndices
 Game::getTransformedBlocks(std::optional<Tetromino> &tetromino) const {
   ShapeIndices indices;
-  auto pattern = shapePatterns.at(tetromino->shape);
-  for (const auto &block : pattern) {
+  for (const auto &block : shapePatterns[(int)tetromino->shape]) {
     const auto rotated = block.pos.rotated(tetromino->orientation);
     indices.push_back({tetromino->position + rotated, block.imageIdx});
   }
@@ -472,59 +630,13 @@ Game::getTransformedBlocks(std::optional<Tetromino> &tetromino) const {
 
 void Tetromino::spinRight() {
   auto ori = int(orientation);
-  auto max_oris = 0;
-  switch (shape) {
-  case Shape::L:
-    max_oris = 4;
-    break;
-  case Shape::J:
-    max_oris = 4;
-    break;
-  case Shape::Z:
-    max_oris = 2;
-    break;
-  case Shape::S:
-    max_oris = 2;
-    break;
-  case Shape::I:
-    max_oris = 2;
-    break;
-  case Shape::T:
-    max_oris = 4;
-    break;
-  case Shape::O:
-    max_oris = 1;
-    break;
-  }
+  auto max_oris = orientationCount(shape);
   orientation = Orientation((ori + 1) % max_oris);
 }
 
 void Tetromino::spinLeft() {
   auto ori = int(orientation);
-  auto max_oris = 0;
-  switch (shape) {
-  case Shape::L:
-    max_oris = 4;
-    break;
-  case Shape::J:
-    max_oris = 4;
-    break;
-  case Shape::Z:
-    max_oris = 2;
-    break;
-  case Shape::S:
-    max_oris = 2;
-    break;
-  case Shape::I:
-    max_oris = 2;
-    break;
-  case Shape::T:
-    max_oris = 4;
-    break;
-  case Shape::O:
-    max_oris = 1;
-    break;
-  }
+  auto max_oris = orientationCount(shape);
   orientation = Orientation((ori - 1 + max_oris) % max_oris);
 }
 
@@ -558,30 +670,196 @@ void Game::applyLineClearScoreAndLevel(size_t linesCleared) {
     linesClearedThisLevel = 0;
   }
 }
-void BoardCell::draw(rayui::LayoutState &state) {
-  if (!cell.empty) {
-    auto destRect = Rectangle{state.position.x, state.position.y,
-                              state.size.width, state.size.height};
-    float size = 8.0f;
-    float idx = (float(cell.imageIdx)) * size;
-    float level = ((float)(game.level % 10)) * size;
+void Game::celebrateLines(const std::vector<size_t> &lines, bool dissolve) {
+  Cue cue = {.kind = Cue::Kind::Lines, .dissolve = dissolve};
+  for (auto line : lines) {
+    if (cue.lineCount < cue.lines.size()) {
+      for (int x = 0; x < board.width; ++x) {
+        cue.rows[cue.lineCount][x] = board.image(x, line);
+      }
+      cue.lines[cue.lineCount++] = line;
+    }
+  }
+  if (deferCues) {
+    cues.push_back(cue);
+    return;
+  }
+  play(cue);
+}
 
-    Rectangle srcRect = {idx, level, size, size};
+// a cue's rows, vanishing from the middle outwards at the same pace as
+// `CellDissolveAnimation`. it's given copies of everything, the game may have
+// moved on to another level or been reset by the time it's done.
+static Effect dissolveRows(Texture2D texture,
+                           std::array<Rectangle, Assets::blockImages> sources,
+                           Game::Cue cue) {
+  constexpr int center = GameBoard::width / 2;
+  constexpr float step = 4 / Game::tickRate;
+  float elapsed = 0;
+  while (true) {
+    const auto &frame = co_await Effect::nextFrame();
+    elapsed += frame.seconds;
+    const int gone = (int)(elapsed / step);
+    if (gone >= center) {
+      co_return;
+    }
+    for (int i = 0; i < cue.lineCount; ++i) {
+      const float top =
+          frame.origin.y +
+          ((int)cue.lines[i] - GameBoard::hiddenRows) * frame.scale.y;
+      for (int x = 0; x < GameBoard::width; ++x) {
+        if (x >= center - gone && x < center + gone) {
+          continue;
+        }
+        frame.list->texture(texture, sources[cue.rows[i][x]],
+                            {frame.origin.x + x * frame.scale.x, top,
+                             frame.scale.x, frame.scale.y});
+      }
+    }
+  }
+}
 
-    DrawTexturePro(game.blockTexture, srcRect, destRect, {0, 0}, 0, WHITE);
+void Game::shatterBoard() {
+  if (deferCues) {
+    cues.push_back({.kind = Cue::Kind::Shatter});
+    return;
   }
-};
+  if (!effects) {
+    return;
+  }
+  const auto &colors = assets->blockColors[level % Assets::palettes];
+  for (int y = board.hiddenRows; y < board.height; ++y) {
+    for (auto row = board.rows[y]; row != 0; row &= row - 1) {
+      int x = std::countr_zero(row);
+      particles.emit(8, {.area = {(float)x, (float)y - board.hiddenRows, 1, 1},
+                         .minVelocity = {-5, -12},
+                         .maxVelocity = {5, 2},
+                         .minSize = 0.15f,
+                         .maxSize = 0.45f,
+                         .minLife = 1.0f,
+                         .maxLife = 2.5f,
+                         .palette = std::span(&colors[board.image(x, y)], 1)});
+    }
+  }
+}
 
-void Game::drawGame() {
+void Game::play(const Cue &cue) {
+  switch (cue.kind) {
+  case Cue::Kind::Sound:
+    playSound(cue.sound);
+    break;
+  case Cue::Kind::Lines: {
+    if (!effects) {
+      break;
+    }
+    const auto palette = level % Assets::palettes;
+    if (cue.dissolve) {
+      effectPlayer.play(dissolveRows(assets->atlas.texture,
+                                     assets->blockSources[palette], cue));
+    }
+    const auto &colors = assets->blockColors[palette];
+    // a tetris goes off a lot bigger.
+    const size_t perLine = cue.lineCount == 4 ? 240 : 60;
+    for (int i = 0; i < cue.lineCount; ++i) {
+      std::array<Color, GameBoard::width> rowColors;
+      for (int x = 0; x < board.width; ++x) {
+        rowColors[x] = colors[cue.rows[i][x]];
+      }
+      particles.emit(perLine,
+                     {.area = {0, (float)cue.lines[i] - board.hiddenRows,
+                               (float)board.width, 1},
+                      .minVelocity = {-6, -16},
+                      .maxVelocity = {6, -4},
+                      .minSize = 0.1f,
+                      .maxSize = 0.35f,
+                      .minLife = 0.6f,
+                      .maxLife = 1.4f,
+                      .palette = rowColors});
+    }
+    break;
+  }
+  case Cue::Kind::Shatter:
+    shatterBoard();
+    break;
+  }
+}
 
-  if (!animation_queue.empty()) {
-    if (animation_queue.front()->invoke()) {
-      animation_queue.pop_front();
+template <typename BoardType>
+void BoardView<BoardType>::draw(rayui::LayoutState &state) {
+  auto &drawList = rayui::drawList();
+  drawList.rectangle(state.position.x, state.position.y, state.size.width,
+                     state.size.height, style.background);
+
+  const auto &texture = game.assets->atlas.texture;
+  if (texture.id == 0) {
+    return;
+  }
+  const auto &sources = game.assets->blockSources[game.level % Assets::palettes];
+  const float cellWidth = state.size.width / board.width;
+  const float cellHeight = state.size.height / board.visibleHeight;
+
+  // a piece that fell a row on the last tick is drawn sliding down from it,
+  // so it moves smoothly however many frames are drawn between ticks. it's
+  // already in the board, so it's cells are left out of the rows below.
+  std::array<typename BoardType::Row, BoardType::height> sliding = {};
+  float slide = 0;
+  const auto &piece = game.tetromino, &before = game.pieceBefore;
+  if (piece && before && before->shape == piece->shape &&
+      before->orientation == piece->orientation &&
+      before->position.x == piece->position.x &&
+      before->position.y + 1 == piece->position.y) {
+    slide = (1 - game.timing.alpha) * cellHeight;
+    for (const auto &block : shapePatterns[(int)piece->shape]) {
+      auto pos = piece->position + block.pos.rotated(piece->orientation);
+      if (board.inBounds(pos.x, pos.y)) {
+        sliding[pos.y] |= typename BoardType::Row(1) << pos.x;
+      }
     }
   }
 
-  const auto screenWidth = (float)GetScreenWidth();
-  const auto screenHeight = (float)GetScreenHeight();
+  // every cell is a quad of the same texture one after another, which the
+  // backend draws as a single batch.
+  for (int y = board.hiddenRows; y < board.height; ++y) {
+    const float top = state.position.y + (y - board.hiddenRows) * cellHeight;
+    // walk just the filled cells of the row.
+    using Row = typename BoardType::Row;
+    for (auto row = Row(board.rows[y] & ~sliding[y]); row != 0;
+         row &= row - 1) {
+      int x = std::countr_zero(row);
+      drawList.texture(texture, sources[board.image(x, y)],
+                       {state.position.x + x * cellWidth, top, cellWidth,
+                        cellHeight});
+    }
+    // the top row has nowhere to slide from on the board.
+    const float offset = y > board.hiddenRows ? slide : 0;
+    for (auto row = sliding[y]; row != 0; row &= row - 1) {
+      int x = std::countr_zero(row);
+      drawList.texture(texture, sources[board.image(x, y)],
+                       {state.position.x + x * cellWidth, top - offset,
+                        cellWidth, cellHeight});
+    }
+  }
+
+  // the particles are only for show, so they move along in real time as
+  // they're drawn.
+  auto &particles = game.particles;
+  if (!particles.empty()) {
+    particles.update(game.timing.seconds);
+    particles.draw(drawList, {state.position.x, state.position.y},
+                   {cellWidth, cellHeight});
+  }
+  if (!game.effectPlayer.empty()) {
+    game.effectPlayer.draw({game.timing.seconds, &drawList,
+                            {state.position.x, state.position.y},
+                            {cellWidth, cellHeight}});
+  }
+}
+template struct boom_tetris::BoardView<GameBoard>;
+
+void Game::drawGame(FrameTiming timing) {
+  this->timing = timing;
+  const auto screenWidth = (float)rayui::drawList().width;
+  const auto screenHeight = (float)rayui::drawList().height;
   const auto unit = std::min(screenWidth / 26, screenHeight / 20);
   const auto uiWidth = unit * 26;
   const auto uiHeight = unit * 20;
@@ -589,25 +867,15 @@ void Game::drawGame() {
   const auto posY = (screenHeight - uiHeight) / 2;
   LayoutState state({posX, posY}, {uiWidth, uiHeight});
   gameGrid.draw(state);
-}
-std::shared_ptr<rayui::Grid> Game::createBoardGrid() {
-  auto grid = std::make_shared<Grid>();
-  grid->style.background = BLACK;
-  grid->subdivisions = {10, 20};
-  int y = 0;
-  for (auto &row : board.rows) {
-    int x = 0;
-    for (auto &cell : row) {
-      grid->emplace_element<BoardCell>(Position{x, y}, *this, cell);
-      x++;
-    }
-    y++;
+  if (resetQueued) {
+    resetQueued = false;
+    reset();
   }
-  return grid;
 }
 void PieceViewer::draw(rayui::LayoutState &state) {
-  DrawRectangle(state.position.x, state.position.y, state.size.width,
-                state.size.height, style.background);
+  rayui::drawList().rectangle(state.position.x, state.position.y,
+                              state.size.width, state.size.height,
+                              style.background);
 
   auto blockSize = std::min(state.size.height / 2, state.size.width / 4);
   auto nextBlockAreaCenterX =
@@ -621,38 +889,16 @@ void PieceViewer::draw(rayui::LayoutState &state) {
     nextBlockAreaCenterY += blockSize / 2;
   }
 
-  for (const auto &block : game.shapePatterns.at(game.nextShape)) {
+  for (const auto &block : shapePatterns[(int)game.nextShape]) {
     auto destX = nextBlockAreaCenterX + block.pos.x * blockSize;
     auto destY = nextBlockAreaCenterY + block.pos.y * blockSize;
     auto destRect = Rectangle{(float)destX, (float)destY, (float)blockSize,
                               (float)blockSize};
-    Rectangle srcRect = {(float)block.imageIdx * 8,
-                         (float)(game.level % 10) * 8, 8, 8};
-    DrawTexturePro(game.blockTexture, srcRect, destRect, {0, 0}, 0, WHITE);
+    auto srcRect =
+        game.assets->blockSources[game.level % Assets::palettes][block.imageIdx];
+    rayui::drawList().texture(game.assets->atlas.texture, srcRect, destRect);
   }
 };
-Vec2 Vec2::operator+(const Vec2 &other) const {
-  return {this->x + other.x, this->y + other.y};
-}
-Vec2 Vec2::rotated(Orientation orientation) const {
-  switch (orientation) {
-  case Orientation::Up:
-    return *this;
-  case Orientation::Left:
-    return {-this->y, this->x};
-  case Orientation::Down:
-    return {-this->x, -this->y};
-  case Orientation::Right:
-    return {this->y, -this->x};
-  }
-}
-int Game::findGamepad() const {
-  for (int i = 0; i < 5; ++i) {
-    if (IsGamepadAvailable(i))
-      return i;
-  }
-  return -1;
-}
 void Game::generateGravityLevels(int totalLevels) {
   float divisor = 48.0;
   gravityLevels.push_back(1.0 / divisor);
@@ -675,47 +921,67 @@ void Game::generateGravityLevels(int totalLevels) {
     gravityLevels.push_back(1.0 / divisor);
   }
 }
-bool CellDissolveAnimation::invoke() {
-  if (cellIdx >= 5) {
-    for (const auto line : lines) {
-      for (int j = line; j >= 1; j--) {
-        game->board.rows[j] = game->board.rows[j - 1];
-      }
-    }
-    game->applyLineClearScoreAndLevel(lines.size());
-    if (game->mode == Game::Mode::FortyLines && game->totalLinesCleared >= 40) {
-      if (game->elapsed.count() < game->scoreFile.fortyLinesPb.count() ||
-          game->scoreFile.fortyLinesPb.count() == 0) {
-        game->scoreFile.fortyLinesPb = game->elapsed;
-      }
-      game->scene = Game::Scene::GameOver;
+void Game::collapseLines(const std::vector<size_t> &lines) {
+  // count the rows dug out of the garbage before they're gone.
+  int dug = 0;
+  for (const auto line : lines) {
+    dug += (int)line >= GameBoard::height - garbageRows;
+  }
+  garbageRows -= dug;
+  garbageCleared += dug;
+
+  for (const auto line : lines) {
+    board.removeRow(line);
+  }
+  applyLineClearScoreAndLevel(lines.size());
+  if (mode == Mode::Versus) {
+    // clearing more than one line at once sends garbage to an opponent.
+    constexpr int garbageSent[] = {0, 0, 1, 2, 4};
+    outgoingGarbage += garbageSent[std::min<size_t>(lines.size(), 4)];
+  }
+  if (mode == Mode::FortyLines && totalLinesCleared >= 40) {
+    if (elapsed.count() < scoreFile.fortyLinesPb.count() ||
+        scoreFile.fortyLinesPb.count() == 0) {
+      scoreFile.fortyLinesPb = elapsed;
     }
-    
+    scene = Scene::GameOver;
+    shatterBoard();
+  }
+}
+bool CellDissolveAnimation::invoke() {
+  // cells vanish from the middle of the row outwards.
+  constexpr int center = GameBoard::width / 2;
+  if (cellIdx >= center) {
+    game->collapseLines(lines);
     return true;
   }
   if (game->frameCount % 4 == 0) {
     for (const auto line : lines) {
-      game->board[4 - cellIdx, line].empty = true;
-      game->board[5 + cellIdx, line].empty = true;
+      game->board.clear(center - 1 - cellIdx, line);
+      game->board.clear(center + cellIdx, line);
     }
     cellIdx++;
   }
 
   return false;
 }
-bool LockInAnimation::invoke() {
-  if (game->bagelMode) {
-    auto prev = game->dependencies;
-    game->dependencies = game->findLongBarDependencies();
-    if (game->dependencies > 1 && game->dependencies > prev) {
-      
-      game->playBoomDependency();
-      std::time_t now = std::time(nullptr);
-      std::cout << "\033[1;32mDependency created\033[0m at " << std::asctime(std::localtime(&now));
+void Game::checkDependencies() {
+  if (!bagelMode) {
+    return;
+  }
+  auto prev = dependencies;
+  dependencies = findLongBarDependencies();
+  if (dependencies > 1 && dependencies > prev) {
+    playBoomDependency();
+    if (traced) {
+      logInfo("dependency created");
     }
   }
+}
+bool LockInAnimation::invoke() {
+  game->checkDependencies();
 
-  if (frameCount == 10 + ((20 - pieceHeight) / 4) * 2) {
+  if (frameCount == 10 + ((GameBoard::height - pieceHeight) / 4) * 2) {
     return true;
   }
   frameCount++;
@@ -727,33 +993,6 @@ void Game::applySoftDropScore(size_t softDropHeight) {
   score += softDropScore;
 };
 
-bool checkDependency(const Board &board, int x, int y) {
-  bool left = false, right = false;
-  left = x - 1 < 0 || !board.rows[y][x - 1].empty;
-  right = x + 1 >= boardHeight || !board.rows[y][x + 1].empty;
-  if (!left || !right) {
-    return false;
-  }
-  for (int dy = y + 2; dy > y; --dy) {
-    if (!board.rows[dy][x].empty) {
-      return false;
-    }
-  }
-  return true;
-}
-
 int boom_tetris::Game::findLongBarDependencies() const {
-  int count = 0;
-  for (int x = 0; x < boardWidth; ++x) {
-    for (int y = 0; y < boardHeight - 2; ++y) {
-      if (!board.rows[y][x].empty) {
-        break;
-      }
-      if (checkDependency(board, x, y)) {
-        count++;
-        break;
-      }
-    }
-  }
-  return count;
-}
+  return boom_tetris::findLongBarDependencies(board);
+}
\ No newline at end of file
@@ -13,7 +13,15 @@
 #include <unordered_map>
 #include <vector>
 
+#include "board.hpp"
+#include "effect.hpp"
+#include "garbage.hpp"
+#include "input.hpp"
+#include "trace.hpp"
+#include "particles.hpp"
+#include "randomizer.hpp"
 #include "score.hpp"
+#include "shape.hpp"
 #include <optional>
 
 constexpr int boardWidth = 10;
@@ -25,48 +33,50 @@ using namespace rayui;
 
 namespace boom_tetris {
 
+// the board the game is played on. the logic and drawing are templated on the
+// board's dimensions, so this is the one place to change them.
+using GameBoard = Board<boardWidth, boardHeight>;
+
 // the direction of user input.
 enum struct Direction { None, Left, Right, Down };
-// the shape of a tetromino, a group of cells.
-enum struct Shape { L, J, Z, S, I, T, O };
-// the rotation of a tetromino
-enum struct Orientation { Up, Right, Down, Left };
-// an integer based vec2.
-struct Vec2 {
-  int x, y;
+// a way to key into the grid to update a tetromino.
+using ShapeIndices = std::vector<Block>;
+// the sounds and the block texture. loaded once, and shared by every game on
+// screen.
+struct Assets {
+  Sound shiftSound;
+  Sound rotateSound;
+  Sound lockInSound;
+  Sound clearLineSound;
+
+  std::vector<Sound> dependencySounds = {};
+  Sound johnnyDependencySound;
+  std::vector<Sound> tetrisSounds = {};
+  std::vector<Sound> bagelSounds = {};
 
-  Vec2 operator+(const Vec2 &other) const;
+  // every image the game draws, blocks and title, packed into one texture so
+  // boards, menus and effects on screen together don't switch between them.
+  rayui::Atlas atlas;
+  // the block image is a grid of 8px blocks: one column per block image, one
+  // row per level palette.
+  static constexpr int blockImages = 4;
+  static constexpr int palettes = 10;
+  // where each block image is in the texture, for every palette (`level %
+  // 10`), worked out once instead of per block.
+  std::array<std::array<Rectangle, blockImages>, palettes> blockSources;
+  Rectangle titleSource;
+  // the color in the middle of each of them, for particles to match.
+  std::array<std::array<Color, blockImages>, palettes> blockColors;
 
-  Vec2 rotated(Orientation orientation) const;
-};
-// an image associated with a cell.
-struct Block {
-  Vec2 pos;
-  size_t imageIdx;
+  Assets();
+  Assets(const Assets &) = delete;
+  Assets &operator=(const Assets &) = delete;
 };
-// a way to key into the grid to update a tetromino.
-using ShapeIndices = std::vector<Block>;
+
 struct HorizontalInput {
   HorizontalInput(bool left, bool right) : left(left), right(right) {}
   bool left, right;
 };
-// a grid cell.
-struct Cell {
-  size_t imageIdx;
-  bool empty = true;
-};
-struct Board {
-  std::array<std::array<Cell, boardWidth>, boardHeight> rows = {};
-  Cell &operator[](int x, int y);
-  Cell &get_cell(int x, int y) { return (*this)[x, y]; }
-  auto begin() noexcept { return rows.begin(); }
-  auto end() noexcept { return rows.end(); }
-
-  // We need more information that just whether it collided or not: we need to
-  // know what side we hit so we can depenetrate in the opposite direction.
-  bool collides(Vec2 pos) noexcept;
-};
-
 // a group of cells the user is currently in control of.
 struct Tetromino {
   size_t softDropHeight = 0;
@@ -93,15 +103,31 @@ struct Game;
 struct PieceViewer : Element {
   Game &game;
   virtual void draw(rayui::LayoutState &state) override;
+  bool changed() const override { return true; }
   PieceViewer(Position position, Size size, Game &game)
       : Element(position, size), game(game) {}
 };
-struct BoardCell : Element {
+
+// a whole board as one element. it walks the filled cells of each row and
+// sends every block as one batch of quads, instead of one element and one
+// texture draw per cell.
+template <typename BoardType> struct BoardView : Element {
   Game &game;
-  Cell &cell;
+  const BoardType &board;
   virtual void draw(rayui::LayoutState &state) override;
-  BoardCell(Position position, Game &game, Cell &cell)
-      : Element(position, {1, 1}), game(game), cell(cell) {}
+  bool changed() const override { return true; }
+  BoardView(Position position, Size size, Game &game, const BoardType &board)
+      : Element(position, size), game(game), board(board) {}
+};
+
+// where a frame being drawn falls among the game's ticks. the game ticks at a
+// fixed rate and drawing keeps up with the display, so a frame is usually
+// somewhere in between two ticks.
+struct FrameTiming {
+  // how far from the last tick to the next, from 0 to 1.
+  float alpha = 1;
+  // real time since the last frame, for things that are only for show.
+  float seconds = 1 / 60.0f;
 };
 
 struct Animation {
@@ -109,6 +135,10 @@ struct Animation {
   Game *game;
   virtual ~Animation() {}
   virtual bool invoke() = 0;
+  // what it's called in a trace.
+  virtual const char *name() const = 0;
+  // a copy playing on the same game, for snapshots.
+  virtual std::unique_ptr<Animation> clone() const = 0;
 };
 struct CellDissolveAnimation : Animation {
   explicit CellDissolveAnimation(Game *game, std::vector<size_t> lines,
@@ -119,6 +149,10 @@ struct CellDissolveAnimation : Animation {
   std::vector<size_t> lines;
   int cellIdx = 0;
   bool invoke() override;
+  const char *name() const override { return "line clear"; }
+  std::unique_ptr<Animation> clone() const override {
+    return std::make_unique<CellDissolveAnimation>(*this);
+  }
 };
 struct LockInAnimation : Animation {
   explicit LockInAnimation(Game *game, int pieceHeight)
@@ -127,6 +161,10 @@ struct LockInAnimation : Animation {
   int frameCount = 0;
   int pieceHeight = 0;
   bool invoke() override;
+  const char *name() const override { return "lock in"; }
+  std::unique_ptr<Animation> clone() const override {
+    return std::make_unique<LockInAnimation>(*this);
+  }
 };
 
 static int randInt(int maxInclusive = 1) {
@@ -134,52 +172,131 @@ static int randInt(int maxInclusive = 1) {
 }
 
 struct Game {
-  Sound shiftSound;
-  Sound rotateSound;
-  Sound lockInSound;
-  Sound clearLineSound;
+  // the rate `processGameLogic` is meant to be called at, an NES's frame rate.
+  // everything in the game is counted in these ticks.
+  static constexpr double tickRate = 60.0988;
+
+  std::shared_ptr<Assets> assets;
+  // keeps this game quiet, for boards that shouldn't be heard.
+  bool silent = false;
   
   bool paused = false;
   
   std::string *volumeLabel = new std::string();
   
-  std::vector<Sound> dependencySounds = {};
-  Sound johnnyDependencySound;
-  std::vector<Sound> tetrisSounds = {};
-  std::vector<Sound> bagelSounds = {};
-  
   bool bagelMode = true;
+  // for training and simulating: a piece locks and it's lines collapse on the
+  // same tick, and the dissolve plays out over the board afterwards instead
+  // of holding the game up.
+  bool turbo = false;
   bool downLocked = false;
+
+  // the buttons held on the last frame, to tell presses apart from holds.
+  InputFrame previousInput;
+  // delayed auto shift, counted in frames so it plays the same at any
+  // framerate: the first auto shift is 16 frames after a press, then the timer
+  // counts down 6 frames between each one after that.
+  static constexpr int dasFrames = 16;
+  static constexpr int arrFrames = 6;
+  int dasTimer = 0;
+  int arrTimer = 0;
+  bool leftKeyPressed = false;
+  bool rightKeyPressed = false;
+  // used to increment until >= 1 so we can have sub-frame velocity for the
+  // tetromino.
+  float budge = 0.0;
   
   ScoreFile scoreFile;
   size_t frameCount = 0;
-  size_t dependencies;
+  size_t dependencies = 0;
+  // everything on the game screen is made in `uiArena` once, and kept for
+  // every game after. it points at the game's fields, so a reset just changes
+  // what they say.
+  rayui::Arena uiArena;
   Grid gameGrid;
+  // the parts of the screen only some modes show, hidden in the others.
+  std::vector<rayui::Element *> fortyLinesElements, digElements;
+  // set by the reset button, so the game isn't reset in the middle of drawing.
+  bool resetQueued = false;
   
   std::deque<std::unique_ptr<Animation>> animation_queue = {};
+  // bits of block flying off cleared lines and a board that's topped out, in
+  // cells from the top left of the visible board. they're only for show, so
+  // they aren't part of a snapshot.
+  Particles particles;
+  // the piece as it was before the last tick, to draw it sliding from there.
+  std::optional<Tetromino> pieceBefore;
+  // where the frame being drawn is, see `drawGame`.
+  FrameTiming timing;
+  // coroutines drawn over the board, like rows dissolving after they're gone
+  // in turbo. only for show and not in a snapshot, same as the particles.
+  EffectPlayer effectPlayer;
+  // whether the game throws particles about. off while frames are played again,
+  // they were seen the first time.
+  bool effects = true;
+  // whether spawns, locks, animations and the like go in the trace. off while
+  // frames are played again too.
+  bool traced = true;
+
+  // a sound or burst of particles the game set off. they change nothing about
+  // how it plays.
+  struct Cue {
+    enum struct Kind { Sound, Lines, Shatter } kind;
+    Sound sound = {};
+    // the rows being cleared, for `Lines`, and what was in them. the board
+    // may have moved on by the time it's played.
+    std::array<uint8_t, 4> lines = {};
+    uint8_t lineCount = 0;
+    std::array<std::array<uint8_t, GameBoard::width>, 4> rows = {};
+    // whether the rows dissolve over the board, for when they're already gone.
+    bool dissolve = false;
+  };
+  // for a game played somewhere other than where it's shown, like on another
+  // thread: what it'd play and show is kept in `cues` instead, to `play` on
+  // the game that's shown.
+  bool deferCues = false;
+  std::vector<Cue> cues;
+  void play(const Cue &cue);
   
   
   enum struct Mode {
     Normal,     // high score
     FortyLines, // timed 40 line clear.
+    Dig,        // dig through garbage that keeps rising from below.
+    Versus,     // one of several boards sending each other garbage.
   } mode = Mode::Normal;
 
+  // dig mode: where the garbage comes from,
+  GarbageGenerator<GameBoard> garbage;
+  // how many rows at the bottom of the board are still garbage,
+  int garbageRows = 0;
+  // rows waiting to be pushed in before the next piece spawns,
+  int pendingGarbage = 0;
+  // and how many garbage rows have been cleared.
+  size_t garbageCleared = 0;
+  // versus: rows of garbage this game's line clears have sent, waiting to be
+  // picked up and passed on to an opponent.
+  int outgoingGarbage = 0;
+  // the garbage dig mode starts with, and the frames between new rows.
+  static constexpr int digStartRows = 9;
+  static constexpr int digRiseFrames = 8 * 60;
+
   // the play grid.
-  Board board;
+  GameBoard board;
   // the upcoming shape & color of the next tetromino.
   Shape nextShape;
+  // where upcoming shapes come from. the policy is picked at compile time.
+  GameRandomizer randomizer;
   // the piece the player is in control of.
   std::optional<Tetromino> tetromino;
+  // how many pieces have spawned this game.
+  size_t pieceCount = 0;
   // time since game start.
   std::chrono::milliseconds elapsed = std::chrono::milliseconds(0);
   // TODO: make this more like classic tetris.
   std::vector<float> gravityLevels;
-  // different shape patterns.
-  static std::unordered_map<Shape, std::vector<Block>> shapePatterns;
   // unit size of a cell on the grid, in pixels. based on resolution
   int blockSize = 32;
-  // the block texture, used and tinted for every block.
-  Texture2D blockTexture;
   // at which rate are we moving the tetromino down?
   float gravity = 0.0f;
   // extra gravity for when the player is holding down.
@@ -195,51 +312,108 @@ struct Game {
   size_t totalLinesCleared = 0;
 
   // used for swapping between menus and the game.
-  enum struct Scene { MainMenu, GameOver, InGame } scene;
+  enum struct Scene { MainMenu, GameOver, InGame, Versus, Online } scene;
 
-  Game();
+  // everything that changes as a game plays, so it can be saved and rewound
+  // to later. see `save` and `load`.
+  struct Snapshot {
+    GameBoard board;
+    std::optional<Tetromino> tetromino;
+    Shape nextShape;
+    GameRandomizer randomizer;
+    GarbageGenerator<GameBoard> garbage;
+    int garbageRows, pendingGarbage, outgoingGarbage;
+    size_t garbageCleared;
+    InputFrame previousInput;
+    int dasTimer, arrTimer;
+    bool leftKeyPressed, rightKeyPressed, downLocked;
+    float budge, gravity, playerGravity;
+    size_t frameCount, pieceCount, dependencies;
+    size_t level, score, linesClearedThisLevel, totalLinesCleared;
+    std::chrono::milliseconds elapsed;
+    Scene scene;
+    std::vector<std::unique_ptr<Animation>> animations;
+  };
+
+  // games share `assets` if given, otherwise they load their own.
+  Game(std::shared_ptr<Assets> assets = nullptr);
   ~Game();
 
   void reset();
+  // copy the game's state into `snapshot`, reusing it's storage.
+  void save(Snapshot &snapshot) const;
+  void load(const Snapshot &snapshot);
+  // a hash of the game's state, to check two copies of a game agree.
+  uint64_t checksum() const;
+  // start dealing pieces and garbage from `seed`. games given the same seed get
+  // the same pieces.
+  void reseed(uint64_t seed);
   Grid createGrid();
-  void drawGame();
-  int findGamepad() const;
+  // shows the parts of the screen `mode` uses, and hides the rest.
+  void showModeElements();
+  // draws the game `timing` into the tick it's on.
+  void drawGame(FrameTiming timing = {});
 
   void generateGravityLevels(int totalLevels);
 
   void setNextShape();
-  void processGameLogic();
+  // pushes `count` rows of garbage in under the stack. false if that pushed
+  // any of the stack out of the top.
+  bool insertGarbage(int count);
+  // the game's over: the stack reached the top.
+  void topOut();
+  // advance the game by one frame with the buttons the player is holding.
+  void processGameLogic(InputFrame input);
+  void updateTetromino(InputFrame input);
   
+  // queues `animation` up behind the ones already playing.
+  void startAnimation(std::unique_ptr<Animation> animation);
   std::vector<size_t> checkLines();
   void applyLineClearScoreAndLevel(size_t linesCleared);
   void applySoftDropScore(size_t softDropHeight);
+  // takes the cleared `lines` out of the board, and scores them.
+  void collapseLines(const std::vector<size_t> &lines);
+  // bagel mode: plays a sound when a piece makes a new long bar dependency.
+  void checkDependencies();
+  // bursts of particles from the `lines` being cleared, and from every block
+  // on the board when the game's over. with `dissolve` the rows are drawn
+  // vanishing where they were too.
+  void celebrateLines(const std::vector<size_t> &lines, bool dissolve = false);
+  void shatterBoard();
   void saveTetromino();
   
-  void playBoomDependency() const {
+  void playSound(Sound sound) {
+    if (deferCues) {
+      cues.push_back({.kind = Cue::Kind::Sound, .sound = sound});
+    } else if (!silent) {
+      tracer().instant("sound");
+      PlaySound(sound);
+    }
+  }
+  void playBoomDependency() {
     static int i = 0;
-    auto sound = dependencySounds[i++ % dependencySounds.size()];
+    auto sound = assets->dependencySounds[i++ % assets->dependencySounds.size()];
     SetSoundVolume(sound, GetMasterVolume() + 0.25f);
-    PlaySound(sound);
+    playSound(sound);
   }
-  void playBoomTetris() const {
+  void playBoomTetris() {
     static int i = 0;
-    auto sound = tetrisSounds[i++ % tetrisSounds.size()];
+    auto sound = assets->tetrisSounds[i++ % assets->tetrisSounds.size()];
     SetSoundVolume(sound, GetMasterVolume() + 0.25f);
-    PlaySound(sound);
+    playSound(sound);
   }
-  void playBoomBagel() const {
+  void playBoomBagel() {
     static int i = 0;
-    auto sound = bagelSounds[i++ % bagelSounds.size()];
+    auto sound = assets->bagelSounds[i++ % assets->bagelSounds.size()];
     SetSoundVolume(sound, GetMasterVolume() + 0.25f);
-    PlaySound(sound);
+    playSound(sound);
   }
   
-  HorizontalInput delayedAutoShift();
+  HorizontalInput delayedAutoShift(InputFrame input);
   void cleanTetromino(std::optional<Tetromino> &tetromino);
   bool resolveCollision(std::optional<Tetromino> &tetromino);
   ShapeIndices
   getTransformedBlocks(std::optional<Tetromino> &tetromino) const;
-  std::shared_ptr<rayui::Grid> createBoardGrid();
 
   int findLongBarDependencies() const;
 };
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+
+namespace boom_tetris {
+
+// runs something at a fixed rate however often frames come around: real time
+// piles up, and is spent a whole tick at a time. what's left over says how
+// far drawing is between the last tick and the next.
+struct FixedTimestep {
+  // seconds a tick.
+  double step;
+  double accumulator = 0;
+  // the most ticks one frame catches up on. after a long stall, like the
+  // window being dragged, the rest is dropped instead of fast forwarding.
+  int maxTicks = 8;
+
+  explicit FixedTimestep(double rate) : step(1 / rate) {}
+
+  // adds `seconds` of real time, and returns how many ticks are due.
+  int advance(double seconds) {
+    accumulator += std::max(seconds, 0.0);
+    int ticks = (int)(accumulator / step);
+    accumulator -= ticks * step;
+    return std::min(ticks, maxTicks);
+  }
+
+  // how far from the last tick to the next, from 0 to 1.
+  float alpha() const { return (float)(accumulator / step); }
+};
+
+} // namespace boom_tetris
@@ -0,0 +1,145 @@
+#include "trace.hpp"
+
+using namespace boom_tetris;
+
+namespace {
+
+// threads are numbered in the order they first trace something.
+uint32_t threadId() {
+  static std::atomic<uint32_t> next = 1;
+  thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+} // namespace
+
+bool Tracer::start(const char *path) {
+  if (enabled()) {
+    return true;
+  }
+  file = fopen(path, "w");
+  if (!file) {
+    return false;
+  }
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  first = true;
+  epoch = Clock::now();
+  // stays around after stopping, for anything still on it's way in.
+  if (!queue) {
+    queue = std::make_unique<Queue>();
+  }
+  stopping = false;
+  writer = std::thread([this] {
+    while (!stopping.load(std::memory_order_relaxed)) {
+      flush();
+      // often enough that the queue never fills up in a frame or two.
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  });
+  on.store(true, std::memory_order_release);
+  return true;
+}
+
+void Tracer::stop() {
+  if (!writer.joinable()) {
+    return;
+  }
+  on.store(false, std::memory_order_release);
+  stopping = true;
+  writer.join();
+  flush();
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  file = nullptr;
+}
+
+void Tracer::instant(const char *name, const char *argName, int64_t arg) {
+  if (enabled()) {
+    push({.name = name,
+          .argName = argName,
+          .arg = arg,
+          .at = Clock::now(),
+          .phase = 'i'});
+  }
+}
+
+void Tracer::complete(const char *name, Clock::time_point start,
+                      Clock::time_point end) {
+  if (enabled()) {
+    push({.name = name, .at = start, .duration = end - start, .phase = 'X'});
+  }
+}
+
+void Tracer::begin(const char *name, uint64_t id) {
+  if (enabled()) {
+    push({.name = name, .at = Clock::now(), .id = id, .phase = 'b'});
+  }
+}
+
+void Tracer::end(const char *name, uint64_t id) {
+  if (enabled()) {
+    push({.name = name, .at = Clock::now(), .id = id, .phase = 'e'});
+  }
+}
+
+void Tracer::nameThread(const char *name) {
+  if (enabled()) {
+    push({.name = name, .at = Clock::now(), .phase = 'M'});
+  }
+}
+
+void Tracer::push(Event event) {
+  event.thread = threadId();
+  if (!queue->push(event)) {
+    lost.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Tracer::flush() {
+  while (auto event = queue->pop()) {
+    write(*event);
+  }
+  fflush(file);
+}
+
+void Tracer::write(const Event &event) {
+  auto micros = [](Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+  fputs(first ? "" : ",\n", file);
+  first = false;
+  switch (event.phase) {
+  case 'X':
+    fprintf(file,
+            "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+            "\"dur\":%.3f}",
+            event.name, event.thread, micros(event.at - epoch),
+            micros(event.duration));
+    break;
+  case 'i':
+    fprintf(file,
+            "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,"
+            "\"ts\":%.3f",
+            event.name, event.thread, micros(event.at - epoch));
+    if (event.argName) {
+      fprintf(file, ",\"args\":{\"%s\":%lld}", event.argName,
+              (long long)event.arg);
+    }
+    fprintf(file, "}");
+    break;
+  case 'b':
+  case 'e':
+    fprintf(file,
+            "{\"name\":\"%s\",\"cat\":\"game\",\"ph\":\"%c\",\"id\":\"0x%llx\","
+            "\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+            event.name, event.phase, (unsigned long long)event.id,
+            event.thread, micros(event.at - epoch));
+    break;
+  case 'M':
+    fprintf(file,
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}",
+            event.thread, event.name);
+    break;
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "mpsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace boom_tetris {
+
+// writes what happens when as Chrome trace events, to open in
+// chrome://tracing or ui.perfetto.dev and line stutters up with what the game
+// was doing. it's off unless started. events from any thread go into a queue
+// made once up front, and a thread of it's own writes them out, so tracing
+// never waits on the disk.
+//
+// names are kept as pointers, so they have to be string literals.
+class Tracer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ~Tracer() { stop(); }
+
+  // starts writing to `path`, false if it can't be opened.
+  bool start(const char *path);
+  // writes out everything left and closes the file.
+  void stop();
+  bool enabled() const { return on.load(std::memory_order_acquire); }
+  // events thrown away because the queue was full.
+  size_t dropped() const { return lost.load(std::memory_order_relaxed); }
+
+  // something that happened at one moment, with a number to go with it if
+  // `argName` isn't null.
+  void instant(const char *name, const char *argName = nullptr,
+               int64_t arg = 0);
+  // something on this thread that took from `start` to `end`.
+  void complete(const char *name, Clock::time_point start,
+                Clock::time_point end);
+  // something that goes on across frames, matched up by `id`.
+  void begin(const char *name, uint64_t id);
+  void end(const char *name, uint64_t id);
+  // what this thread's called in the trace.
+  void nameThread(const char *name);
+
+private:
+  struct Event {
+    const char *name = nullptr;
+    const char *argName = nullptr;
+    int64_t arg = 0;
+    Clock::time_point at;
+    Clock::duration duration = {};
+    uint64_t id = 0;
+    uint32_t thread = 0;
+    // as in the trace event format: X, i, b, e or M.
+    char phase = 0;
+  };
+  using Queue = MpscQueue<Event, 1 << 16>;
+
+  void push(Event event);
+  void flush();
+  void write(const Event &event);
+
+  std::atomic<bool> on = false, stopping = false;
+  std::atomic<size_t> lost = 0;
+  std::unique_ptr<Queue> queue;
+  std::thread writer;
+  FILE *file = nullptr;
+  bool first = true;
+  Clock::time_point epoch;
+};
+
+// the tracer for the whole game.
+inline Tracer &tracer() {
+  static Tracer tracer;
+  return tracer;
+}
+
+} // namespace boom_tetris
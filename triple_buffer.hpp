@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace boom_tetris {
+
+// hands the newest of a stream of values from one thread to another without
+// either ever waiting on the other. the writer fills in `back` and publishes
+// it, the reader picks up whatever was published last, and values it was too
+// slow to see are skipped. there are three slots: one being written, one
+// being read, and the newest one waiting in between.
+template <typename T> class TripleBuffer {
+public:
+  // the slot to write the next value into. only for the writing thread.
+  T &back() { return slots[backIndex]; }
+  // swaps the back slot for the one in between, handing it over to the
+  // reader.
+  void publish() {
+    backIndex = middle.exchange(backIndex | fresh, std::memory_order_acq_rel) &
+                index;
+  }
+
+  // moves on to the newest value published, if there's been one since last
+  // time. only for the reading thread.
+  bool update() {
+    if (!(middle.load(std::memory_order_relaxed) & fresh)) {
+      return false;
+    }
+    frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & index;
+    return true;
+  }
+  const T &front() const { return slots[frontIndex]; }
+
+private:
+  // the slot in between, and whether it's been published since it was read.
+  static constexpr uint8_t index = 3, fresh = 4;
+  std::array<T, 3> slots;
+  std::atomic<uint8_t> middle{1};
+  uint8_t backIndex = 0, frontIndex = 2;
+};
+
+} // namespace boom_tetris
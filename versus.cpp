@@ -0,0 +1,234 @@
+#include "versus.hpp"
+#include <algorithm>
+#include <array>
+#include <string>
+
+using namespace boom_tetris;
+
+namespace {
+
+// a bar that grows with the garbage waiting to come up under a board.
+struct GarbageMeter : Element {
+  const int &pending;
+  GarbageMeter(Position position, Size size, const int &pending)
+      : Element(position, size), pending(pending) {}
+  bool changed() const override { return true; }
+  void draw(LayoutState &state) override {
+    auto &drawList = rayui::drawList();
+    drawList.rectangle(state.position.x, state.position.y, state.size.width,
+                       state.size.height, BLACK);
+    auto rows = std::min(pending, GameBoard::visibleHeight);
+    auto height = state.size.height * rows / GameBoard::visibleHeight;
+    drawList.rectangle(state.position.x,
+                       state.position.y + state.size.height - height,
+                       state.size.width, height, RED);
+  }
+};
+
+const char *controllerName(Versus::Controller controller) {
+  switch (controller) {
+  case Versus::Controller::Keyboard:
+    return "Keyboard";
+  case Versus::Controller::Gamepad:
+    return "Gamepad";
+  case Versus::Controller::Bot:
+    return "Bot";
+  case Versus::Controller::Remote:
+    return "Remote";
+  }
+  return "";
+}
+
+} // namespace
+
+void Versus::start(int boards, uint64_t seed) {
+  boards = std::clamp(boards, minBoards, maxBoards);
+
+  std::span<const int> gamepads;
+  if (devices) {
+    gamepads = devices->gamepads();
+  }
+
+  std::vector<Player> players(boards);
+  for (int i = 0; i < boards; ++i) {
+    if (i == 0) {
+      players[i].controller = Controller::Keyboard;
+    } else if (i - 1 < (int)gamepads.size()) {
+      players[i].controller = Controller::Gamepad;
+      players[i].gamepad = gamepads[i - 1];
+    }
+  }
+  start(std::move(players), seed);
+}
+
+void Versus::start(std::vector<Player> players, uint64_t seed) {
+  this->players = std::move(players);
+  winner = std::nullopt;
+
+  bool heard = false;
+  for (auto &player : this->players) {
+    player.game = std::make_unique<Game>(assets);
+    auto &game = *player.game;
+    // only the first human player's board is heard, it'd be a racket
+    // otherwise.
+    bool human = player.controller == Controller::Keyboard ||
+                 player.controller == Controller::Gamepad;
+    game.silent = heard || !human;
+    heard = heard || human;
+    game.mode = Game::Mode::Versus;
+    game.startLevel = startLevel;
+    game.reseed(seed);
+    game.reset();
+    game.scene = Game::Scene::InGame;
+  }
+  grid = createGrid();
+}
+
+void Versus::processGameLogic() {
+  std::array<InputFrame, maxBoards> inputs;
+  for (int i = 0; i < (int)players.size(); ++i) {
+    auto &player = players[i];
+    switch (player.controller) {
+    case Controller::Keyboard:
+      if (devices) {
+        inputs[i] = devices->keyboard();
+      }
+      break;
+    case Controller::Gamepad:
+      if (devices) {
+        inputs[i] = devices->gamepad(player.gamepad);
+      }
+      break;
+    case Controller::Bot:
+      inputs[i] = player.bot.play(*player.game);
+      break;
+    case Controller::Remote:
+      break;
+    }
+  }
+  step(std::span(inputs).first(players.size()));
+}
+
+void Versus::step(std::span<const InputFrame> inputs) {
+  if (winner) {
+    return;
+  }
+  int alive = 0;
+  for (int i = 0; i < (int)players.size(); ++i) {
+    auto &game = *players[i].game;
+    if (game.scene == Game::Scene::GameOver) {
+      continue;
+    }
+    game.processGameLogic(inputs[i]);
+    alive += game.scene != Game::Scene::GameOver;
+  }
+  sendGarbage();
+
+  if (alive <= 1) {
+    // nobody left standing is a draw.
+    winner = -1;
+    for (int i = 0; i < (int)players.size(); ++i) {
+      if (players[i].game->scene != Game::Scene::GameOver) {
+        winner = i;
+      }
+    }
+    winnerText = *winner >= 0 ? "P" + std::to_string(*winner + 1) + " wins!"
+                              : "Draw!";
+  }
+}
+
+void Versus::sendGarbage() {
+  const int count = players.size();
+  for (int i = 0; i < count; ++i) {
+    auto &game = *players[i].game;
+    auto sent = game.outgoingGarbage;
+    game.outgoingGarbage = 0;
+    // garbage sent cancels out garbage on it's way in first.
+    auto cancelled = std::min(sent, game.pendingGarbage);
+    game.pendingGarbage -= cancelled;
+    sent -= cancelled;
+    if (sent == 0) {
+      continue;
+    }
+    // the rest goes to the next board still in the game.
+    for (int j = 1; j < count; ++j) {
+      auto &opponent = *players[(i + j) % count].game;
+      if (opponent.scene != Game::Scene::GameOver) {
+        opponent.pendingGarbage += sent;
+        break;
+      }
+    }
+  }
+}
+
+Grid Versus::createGrid() {
+  // up to 4 boards a row, each in a 13x23 panel.
+  const int columns = std::min<int>(players.size(), 4);
+  const int rows = (players.size() + columns - 1) / columns;
+  arena.reset();
+  Grid grid(arena, {columns * 13, rows * 23});
+  grid.style.background = BG_COLOR;
+
+  for (int i = 0; i < (int)players.size(); ++i) {
+    auto &player = players[i];
+    auto &game = *player.game;
+    auto panel = grid.emplace_element<Grid>(Position{(i % columns) * 13,
+                                                     (i / columns) * 23},
+                                            Size{13, 23});
+    panel->subdivisions = {13, 23};
+
+    // the name and line count hardly change, keep them drawn in a texture.
+    auto layer = panel->emplace_element<Layer>(Position{0, 0}, Size{13, 23});
+    layer->subdivisions = {13, 23};
+    layer->style.background = GetColor(0x121212ff);
+    layer->emplace_element<Label>(
+        Position{0, 0}, Size{1, 1},
+        "P" + std::to_string(i + 1) + " " + controllerName(player.controller),
+        WHITE);
+    layer->emplace_element<NumberText>(Position{11, 4}, Size{2, 1},
+                                       &game.totalLinesCleared, WHITE);
+    panel->emplace_element<GarbageMeter>(Position{0, 2}, Size{1, 20},
+                                         game.pendingGarbage);
+    auto board = panel->emplace_element<BoardView<GameBoard>>(
+        Position{1, 2}, Size{10, 20}, game, game.board);
+    board->style.background = BLACK;
+    auto pieceViewer = panel->emplace_element<PieceViewer>(Position{11, 2},
+                                                           Size{2, 1}, game);
+    pieceViewer->style.background = BLACK;
+  }
+  return grid;
+}
+
+void Versus::draw(FrameTiming timing) {
+  for (auto &player : players) {
+    player.game->timing = timing;
+  }
+  const auto screenWidth = (float)rayui::drawList().width;
+  const auto screenHeight = (float)rayui::drawList().height;
+  const auto unit = std::min(screenWidth / grid.subdivisions.width,
+                             screenHeight / grid.subdivisions.height);
+  const auto uiWidth = unit * grid.subdivisions.width;
+  const auto uiHeight = unit * grid.subdivisions.height;
+  LayoutState state({(screenWidth - uiWidth) / 2, (screenHeight - uiHeight) / 2},
+                    {uiWidth, uiHeight});
+  grid.draw(state);
+
+  const int columns = std::min<int>(players.size(), 4);
+  for (int i = 0; i < (int)players.size(); ++i) {
+    if (players[i].game->scene == Game::Scene::GameOver) {
+      // grey out the boards that are out of the match.
+      rayui::drawList().rectangle(
+          state.position.x + (i % columns) * 13 * unit,
+          state.position.y + (i / columns) * 23 * unit, 13 * unit, 23 * unit,
+          GetColor(0x12121299));
+    }
+  }
+
+  if (winner) {
+    auto fontSize = (int)(2 * unit);
+    auto text = winnerText + " [Enter]";
+    auto width = MeasureText(text.c_str(), fontSize);
+    rayui::drawList().text(text.c_str(), (screenWidth - width) / 2,
+                           (screenHeight - fontSize) / 2, fontSize, GREEN);
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "bot.hpp"
+#include "rayui.hpp"
+#include "tetris.hpp"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace boom_tetris {
+
+// local versus: 2 to 8 boards on one screen, all dealt the same pieces, that
+// send each other garbage when they clear more than one line at a time.
+struct Versus {
+  static constexpr int minBoards = 2;
+  static constexpr int maxBoards = 8;
+  static constexpr size_t startLevel = 5;
+
+  // where a board's input comes from. remote boards are fed by `step`.
+  enum struct Controller { Keyboard, Gamepad, Bot, Remote };
+
+  struct Player {
+    std::unique_ptr<Game> game;
+    Controller controller = Controller::Bot;
+    int gamepad = -1;
+    Bot bot;
+  };
+
+  std::shared_ptr<Assets> assets;
+  // where the keyboard and gamepad players' input comes from. without any,
+  // they stand still.
+  const InputDevices *devices = nullptr;
+  std::vector<Player> players;
+  // the index of the last one standing once the match is over, -1 for a draw.
+  std::optional<int> winner;
+  std::string winnerText;
+  // the panels of the boards, all freed at once when a new match starts.
+  rayui::Arena arena;
+  Grid grid;
+
+  Versus(std::shared_ptr<Assets> assets) : assets(std::move(assets)) {}
+
+  // start a new match on `boards` boards. the keyboard and every connected
+  // gamepad get one, and bots play the rest.
+  void start(int boards, uint64_t seed);
+  // start a new match with a board for each of `players`.
+  void start(std::vector<Player> players, uint64_t seed);
+  // advance every board by one frame, reading each player's controller.
+  void processGameLogic();
+  // advance every board by one frame with `inputs`, one per player. the same
+  // inputs from the same state always play out the same.
+  void step(std::span<const InputFrame> inputs);
+  // draws every board `timing` into the tick they're on.
+  void draw(FrameTiming timing = {});
+
+private:
+  // hand the garbage every board sent this frame on to it's opponent.
+  void sendGarbage();
+  Grid createGrid();
+};
+
+} // namespace boom_tetris